@@ -0,0 +1,264 @@
+#include "mlx90640_host.h"
+
+#include <string.h>
+
+#include "MLX90640_I2C_Driver.h"
+
+/* ================= 无总线 ================= */
+__attribute__((weak)) int MLX90640_I2CRead(uint8_t slaveAddr, uint16_t reg, uint16_t len, uint16_t *data)
+{
+    return -1;
+}
+
+__attribute__((weak)) int MLX90640_I2CWrite(uint8_t slaveAddr, uint16_t reg, uint16_t data)
+{
+    return -1;
+}
+
+__attribute__((weak)) int MLX90640_I2CGeneralReset(void)
+{
+    return -1;
+}
+
+/* ================= 子页配对 ================= */
+void mlx_host_pair_reset(mlx_host_pair_t *p)
+{
+    memset(p, 0, sizeof(*p));
+    p->last_subpage = -1;
+}
+
+int mlx_host_pair_push(mlx_host_pair_t *p, uint32_t seq, const uint16_t *words)
+{
+    int subpage = words[833] & 0x1;
+    int second = 0;
+
+    if (p->have_seq && seq != p->last_seq + 1) {
+        p->gaps++;
+        p->pending = 0;
+    }
+    p->have_seq = 1;
+    p->last_seq = seq;
+
+    if (p->pending && p->last_subpage == !subpage) {
+        second = 1;
+        p->pending = 0;
+    } else {
+        p->pending = 1;
+    }
+    p->last_subpage = subpage;
+    return second;
+}
+
+/* ================= 标定 / 拼帧 ================= */
+void mlx_host_init(mlx_host_t *h, float emissivity, float ta_shift)
+{
+    memset(h, 0, sizeof(*h));
+    mlx_frame_assembler_init(&h->fa, &h->params, emissivity, ta_shift);
+    mlx_host_pair_reset(&h->pair);
+}
+
+int mlx_host_load_calib(mlx_host_t *h, const uint16_t *eeData)
+{
+    if (h->have_calib && memcmp(h->ee, eeData, sizeof(h->ee)) == 0) {
+        return 0;
+    }
+    memcpy(h->ee, eeData, sizeof(h->ee));
+    int ret = MLX90640_ExtractParameters(h->ee, &h->params);
+    h->have_calib = (ret == 0);
+    mlx_frame_assembler_reset(&h->fa);
+    h->pair.pending = 0;
+    return ret;
+}
+
+int mlx_host_push_raw(mlx_host_t *h, mlx_raw_frame_t *rf, mlx_frame_t *out)
+{
+    uint32_t gaps = h->pair.gaps;
+    int second = mlx_host_pair_push(&h->pair, rf->seq, rf->words);
+
+    h->stats.raw++;
+    h->stats.gaps += h->pair.gaps - gaps;
+    if (!h->have_calib) {
+        h->stats.no_calib++;
+        return -1;
+    }
+    /* 帧边界以配对结果为准：一帧的第一个子页让拼接器从它重新开始 */
+    if (!second) {
+        mlx_frame_assembler_reset(&h->fa);
+    }
+    if (!mlx_frame_assembler_push(&h->fa, rf->words, rf->t_us, out)) {
+        return 0;
+    }
+    h->stats.frames++;
+    return 1;
+}
+
+/* ================= packet 解析 ================= */
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+/* ================= 设备端温度帧 ================= */
+static void frame_header(const uint8_t *body, mlx_frame_t *out)
+{
+    out->seq = get_u32(body);
+    out->t_last_us = (int64_t)(get_u32(body + 4) | ((uint64_t)get_u32(body + 8) << 32));
+    out->t_first_us = out->t_last_us;
+    out->ta = (int16_t)get_u16(body + 12) / 100.0f;
+    out->vdd = get_u16(body + 14) / 1000.0f;
+    out->ctrl = get_u16(body + 16);
+    out->subpage = body[18];
+}
+
+static void frame_from_ref(mlx_host_t *h, mlx_frame_t *out)
+{
+    for (int i = 0; i < MLX90640_PIXEL_NUM; i++) {
+        out->to[i] = h->ref[i] / 100.0f;
+    }
+    h->ref_seq = out->seq;
+    h->have_ref = 1;
+    h->stats.frames++;
+}
+
+/* 768 个 zig-zag varint 加到参考帧上；长度不对返回 -1（参考帧已被部分修改，调用方作废） */
+static int apply_delta(mlx_host_t *h, const uint8_t *p, size_t len)
+{
+    size_t pos = 0;
+    for (int i = 0; i < MLX90640_PIXEL_NUM; i++) {
+        uint32_t v = 0;
+        int shift = 0;
+        do {
+            if (pos >= len || shift > 14) {
+                return -1;
+            }
+            v |= (uint32_t)(p[pos] & 0x7F) << shift;
+            shift += 7;
+        } while (p[pos++] & 0x80);
+        h->ref[i] = (int16_t)(h->ref[i] + (int32_t)((v >> 1) ^ -(v & 1)));
+    }
+    return pos == len ? 0 : -1;
+}
+
+int mlx_host_parse_metrics(const uint8_t *pkt, size_t len, mlx_sysmon_record_t *rec)
+{
+    const uint8_t *body = pkt + 2;
+
+    if (len < MLX_PROTO_METRICS_HDR || pkt[1] != MLX_PROTO_TYPE_METRICS) {
+        return -1;
+    }
+    uint8_t n = body[6];
+    if (n > MLX_SYSMON_MAX_TASKS || len != MLX_PROTO_METRICS_HDR + (size_t)n * MLX_PROTO_METRICS_TASK) {
+        return -1;
+    }
+
+    memset(rec, 0, sizeof(*rec));
+    rec->uptime_ms = get_u32(body);
+    rec->cpu_pct[0] = body[4];
+    rec->cpu_pct[1] = body[5];
+    rec->ntasks = n;
+    rec->heap_free = get_u32(body + 8);
+    rec->heap_min_free = get_u32(body + 12);
+    rec->heap_largest = get_u32(body + 16);
+    rec->psram_free = get_u32(body + 20);
+    for (int i = 0; i < n; i++) {
+        const uint8_t *p = pkt + MLX_PROTO_METRICS_HDR + i * MLX_PROTO_METRICS_TASK;
+        mlx_sysmon_task_t *t = &rec->tasks[i];
+        memcpy(t->name, p, MLX_SYSMON_NAME_LEN - 1);
+        t->core = p[MLX_SYSMON_NAME_LEN];
+        t->cpu_pct = p[MLX_SYSMON_NAME_LEN + 1];
+        t->stack_free = get_u16(p + MLX_SYSMON_NAME_LEN + 2);
+    }
+    return 0;
+}
+
+int mlx_host_packet(mlx_host_t *h, const uint8_t *pkt, size_t len, mlx_frame_t *out)
+{
+    const uint8_t *body = pkt + 2;
+    const size_t hdr = MLX_PROTO_FRAME_HDR - 2;
+
+    h->stats.packets++;
+    if (pkt[1] == MLX_PROTO_TYPE_CALIB && len == MLX_PROTO_CALIB_SIZE - 4) {
+        uint16_t ee[MLX90640_EEPROM_DUMP_NUM];
+        for (int i = 0; i < MLX90640_EEPROM_DUMP_NUM; i++) {
+            ee[i] = get_u16(body + i * 2);
+        }
+        h->stats.calib++;
+        mlx_host_load_calib(h, ee);
+        return 0;
+    }
+    if (pkt[1] == MLX_PROTO_TYPE_RAW && len == MLX_PROTO_RAW_SIZE - 4) {
+        mlx_raw_frame_t *rf = &h->raw;
+        rf->seq = get_u32(body);
+        rf->t_us = (int64_t)(get_u32(body + 4) | ((uint64_t)get_u32(body + 8) << 32));
+        for (int i = 0; i < MLX_RAW_WORDS; i++) {
+            rf->words[i] = get_u16(body + 12 + i * 2);
+        }
+        if (h->on_raw) {
+            h->on_raw(rf, h->on_raw_ctx);
+        }
+        return mlx_host_push_raw(h, rf, out);
+    }
+    if (pkt[1] == MLX_PROTO_TYPE_FRAME && len == MLX_PROTO_FRAME_SIZE - 4) {
+        frame_header(body, out);
+        for (int i = 0; i < MLX90640_PIXEL_NUM; i++) {
+            h->ref[i] = (int16_t)get_u16(body + hdr + i * 2);
+        }
+        frame_from_ref(h, out);
+        return 1;
+    }
+    if (pkt[1] == MLX_PROTO_TYPE_FRAME_DELTA && len > hdr + 2) {
+        frame_header(body, out);
+        if (!h->have_ref || out->seq != h->ref_seq + 1 ||
+            apply_delta(h, body + hdr, len - 2 - hdr) != 0) {
+            h->have_ref = 0;            // 等下一个关键帧
+            h->stats.delta_skipped++;
+            return 0;
+        }
+        frame_from_ref(h, out);
+        return 1;
+    }
+    if (pkt[1] == MLX_PROTO_TYPE_METRICS && mlx_host_parse_metrics(pkt, len, &h->metrics) == 0) {
+        h->stats.metrics++;
+        if (h->on_metrics) {
+            h->on_metrics(&h->metrics, h->on_metrics_ctx);
+        }
+        return 0;
+    }
+    h->stats.other++;
+    return 0;
+}
+
+void mlx_host_feed(mlx_host_t *h, const uint8_t *data, size_t len,
+                   mlx_host_frame_cb_t cb, void *ctx)
+{
+    for (size_t i = 0; i < len; i++) {
+        uint8_t b = data[i];
+        if (b != 0x00) {
+            if (h->chunk_len < sizeof(h->chunk)) {
+                h->chunk[h->chunk_len++] = b;
+            } else {
+                h->overflow = 1;
+            }
+            continue;
+        }
+
+        /* 0x00：一段结束，空段是包间的分隔符 */
+        if (h->overflow) {
+            h->stats.bad++;
+        } else if (h->chunk_len > 0) {
+            int n = mlx_proto_decode(h->chunk, h->chunk_len, h->pkt, sizeof(h->pkt));
+            if (n < 0) {
+                h->stats.bad++;
+            } else if (mlx_host_packet(h, h->pkt, (size_t)n, &h->out) == 1 && cb) {
+                cb(&h->out, ctx);
+            }
+        }
+        h->chunk_len = 0;
+        h->overflow = 0;
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "MLX90640_API.h"
+#include "mlx_frame.h"
+#include "mlx_proto.h"
+
+/*
+ * 主机端标定库
+ *
+ * 设备以 raw 输出（main.c 的 OUTPUT_RAW）时只发原始子页和 EEPROM 标定包，
+ * 这里用与固件同一份 MLX90640_API.c / mlx_frame.c 在主机上算温度：
+ *
+ *   CALIB 包 → MLX90640_ExtractParameters
+ *   RAW 包   → mlx_frame_assembler_push → 整帧回调
+ *
+ * 设备端已算好温度的 FRAME / FRAME_DELTA 包也在这里还原成 mlx_frame_t，
+ * 所以 mlx_host_feed 对任何一种二进制输出都给出同样的整帧回调。
+ * 随帧发送的 METRICS 包解成 mlx_sysmon_record_t，保存在 metrics 并调用 on_metrics。
+ *
+ * 不依赖 I2C：MLX90640_API.c 引用的总线函数在这里有弱定义的空实现，
+ * 与 mlx90640_sim.c / mlx90640_replay.c 一起链接时以它们为准。
+ *
+ * 构建（在仓库根目录）：
+ *   gcc -O2 -Imain -Ihost main/MLX90640_API.c main/mlx_frame.c main/mlx_proto.c \
+ *       host/mlx90640_host.c host/raw_recv.c -lm -o raw_recv
+ */
+
+#define MLX_HOST_CHUNK_MAX  MLX_PROTO_WIRE_MAX(MLX_PROTO_RAW_SIZE)
+
+typedef struct {
+    uint32_t packets;
+    uint32_t bad;               // COBS / CRC 错误或超长
+    uint32_t calib;
+    uint32_t raw;
+    uint32_t no_calib;          // 还没收到标定包时到达的子页
+    uint32_t gaps;              // 子页序号不连续（设备或链路丢包）
+    uint32_t frames;            // 整帧回调次数（含 FRAME / FRAME_DELTA）
+    uint32_t delta_skipped;     // 没有参考帧而丢弃的差分帧
+    uint32_t metrics;           // 设备资源监控包
+    uint32_t other;             // 未知类型的包，忽略
+} mlx_host_stats_t;
+
+/*
+ * 子页配对：主机端唯一的一份规则，mlx_host_push_raw、rec_convert 和 mlx_lib_pair 都用它，
+ * 与 mlx_frame_assembler_push 的拼接一致：
+ * 序号不连续时重新开始，只接受与上一个相反的子页作为一帧的第二个子页。
+ * 只看序号和 words[833]，不做温度计算，批量工具可以先扫一遍定出帧边界。
+ */
+typedef struct {
+    int      have_seq;
+    uint32_t last_seq;
+    int      last_subpage;
+    int      pending;           // 上一个子页已到、等待配对
+    uint32_t gaps;              // 序号不连续的次数
+} mlx_host_pair_t;
+
+void mlx_host_pair_reset(mlx_host_pair_t *p);
+
+/* 输入下一个子页：与前一个子页凑成一整帧返回 1（它是第二个子页），否则返回 0 */
+int  mlx_host_pair_push(mlx_host_pair_t *p, uint32_t seq, const uint16_t *words);
+
+typedef void (*mlx_host_frame_cb_t)(const mlx_frame_t *f, void *ctx);
+typedef void (*mlx_host_raw_cb_t)(const mlx_raw_frame_t *rf, void *ctx);
+typedef void (*mlx_host_metrics_cb_t)(const mlx_sysmon_record_t *rec, void *ctx);
+
+typedef struct {
+    paramsMLX90640 params;
+    mlx_frame_assembler_t fa;
+    uint16_t ee[MLX90640_EEPROM_DUMP_NUM];
+    int      have_calib;
+    mlx_host_pair_t pair;
+
+    /* 字节流切分 */
+    uint8_t  chunk[MLX_HOST_CHUNK_MAX];
+    size_t   chunk_len;
+    int      overflow;          // 当前段超长，丢到下一个 0x00
+    uint8_t  pkt[MLX_HOST_CHUNK_MAX];
+    mlx_raw_frame_t raw;
+    mlx_frame_t out;
+
+    /* 差分帧的参考帧（0.01°C） */
+    int16_t  ref[MLX90640_PIXEL_NUM];
+    uint32_t ref_seq;
+    int      have_ref;
+
+    /* 可选：每个 RAW 子页（不论是否已标定）解析后调用，录制原始数据用 */
+    mlx_host_raw_cb_t on_raw;
+    void    *on_raw_ctx;
+
+    /* 最近一条设备资源监控记录（stats.metrics 为 0 时无效）；可选回调 */
+    mlx_sysmon_record_t metrics;
+    mlx_host_metrics_cb_t on_metrics;
+    void    *on_metrics_ctx;
+
+    mlx_host_stats_t stats;
+} mlx_host_t;
+
+void mlx_host_init(mlx_host_t *h, float emissivity, float ta_shift);
+
+/* 加载 EEPROM 镜像；与当前一致时不重复解析。返回 ExtractParameters 的结果 */
+int  mlx_host_load_calib(mlx_host_t *h, const uint16_t *eeData);
+
+/* 输入一个原始子页：凑齐整帧返回 1 并写入 out，未凑齐返回 0，未标定返回 -1 */
+int  mlx_host_push_raw(mlx_host_t *h, mlx_raw_frame_t *rf, mlx_frame_t *out);
+
+/* METRICS packet → mlx_sysmon_record_t，长度不符返回 -1 */
+int  mlx_host_parse_metrics(const uint8_t *pkt, size_t len, mlx_sysmon_record_t *rec);
+
+/* 输入一个 mlx_proto_decode 得到的 packet：得到整帧返回 1 并写入 out，否则返回 0 或 -1 */
+int  mlx_host_packet(mlx_host_t *h, const uint8_t *pkt, size_t len, mlx_frame_t *out);
+
+/* 输入任意长度的线上字节流，每拼好一整帧调用一次 cb */
+void mlx_host_feed(mlx_host_t *h, const uint8_t *data, size_t len,
+                   mlx_host_frame_cb_t cb, void *ctx);
@@ -0,0 +1,69 @@
+#include "mlx90640_lib.h"
+
+#include <string.h>
+
+#include "mlx_frame.h"
+#include "mlx90640_host.h"
+
+size_t mlx_lib_params_size(void)
+{
+    return sizeof(paramsMLX90640);
+}
+
+void mlx_lib_bad_pixels(const paramsMLX90640 *params, float *to, int mode)
+{
+    paramsMLX90640 *p = (paramsMLX90640 *)params;     // API 不改参数，只是没有标 const
+
+    MLX90640_BadPixelsCorrection(p->brokenPixels, to, mode, p);
+    MLX90640_BadPixelsCorrection(p->outlierPixels, to, mode, p);
+}
+
+/* ================= 批量 ================= */
+size_t mlx_lib_pair(const uint16_t *raw, const uint32_t *seq, size_t n, uint64_t *second)
+{
+    mlx_host_pair_t pair;
+    size_t frames = 0;
+
+    mlx_host_pair_reset(&pair);
+    for (size_t i = 0; i < n; i++) {
+        if (mlx_host_pair_push(&pair, seq ? seq[i] : (uint32_t)i, raw + i * MLX_RAW_WORDS)) {
+            second[frames++] = i;
+        }
+    }
+    return frames;
+}
+
+size_t mlx_lib_convert(const uint16_t *raw, const uint64_t *second, size_t m,
+                       const paramsMLX90640 *params, float emissivity, float ta_shift,
+                       int tr_fixed, float tr, float *to, float *ta, float *vdd)
+{
+    mlx_frame_assembler_t fa;
+    mlx_frame_t out;
+    uint16_t words[MLX_RAW_WORDS];
+    size_t failed = 0;
+
+    mlx_frame_assembler_init(&fa, (paramsMLX90640 *)params, emissivity, ta_shift);
+    fa.tr_fixed = tr_fixed != 0;
+    fa.tr = tr;
+
+    for (size_t k = 0; k < m; k++) {
+        const uint16_t *sp = raw + second[k] * MLX_RAW_WORDS;
+
+        mlx_frame_assembler_reset(&fa);
+        memcpy(words, sp - MLX_RAW_WORDS, sizeof(words));
+        mlx_frame_assembler_push(&fa, words, 0, &out);
+        memcpy(words, sp, sizeof(words));
+        if (!mlx_frame_assembler_push(&fa, words, 0, &out)) {
+            failed++;
+            continue;
+        }
+        memcpy(to + k * MLX90640_PIXEL_NUM, out.to, sizeof(out.to));
+        if (ta) {
+            ta[k] = out.ta;
+        }
+        if (vdd) {
+            vdd[k] = out.vdd;
+        }
+    }
+    return failed;
+}
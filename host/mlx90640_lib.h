@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "MLX90640_API.h"
+
+/*
+ * 给 Python（ctypes，main/mlx_native.py）用的共享库接口
+ *
+ * 单帧内核直接导出 MLX90640_API.c 里的原函数（ExtractParameters / GetTa / GetVdd /
+ * GetImage / CalculateTo / BadPixelsCorrection），这里只补 ctypes 不方便做的部分：
+ * paramsMLX90640 的大小（Python 侧当作不透明缓冲区）、两张坏点表一起修正、
+ * 以及成批的子页配对和整帧换算。所有函数只读写调用方给的缓冲区，可以多线程并发调用。
+ *
+ * 构建（在仓库根目录）：
+ *   gcc -O2 -shared -fPIC -Imain -Ihost main/MLX90640_API.c main/mlx_frame.c main/mlx_proto.c \
+ *       host/mlx90640_host.c host/mlx90640_lib.c -lm -o host/libmlx90640.so
+ */
+
+size_t mlx_lib_params_size(void);
+
+/* brokenPixels 和 outlierPixels 都修正，mode 取自控制寄存器 bit 12（与 mlx_frame.c 相同） */
+void mlx_lib_bad_pixels(const paramsMLX90640 *params, float *to, int mode);
+
+/*
+ * n 个原始子页（raw[i * 834]）配对成整帧，逐个经 mlx_host_pair_push（规则见 mlx90640_host.h）。
+ * seq 可为 NULL（视为连续）。
+ * second[k] 写入第 k 帧第二个子页的下标（第一个是 second[k] - 1），返回帧数（最多 n / 2）。
+ */
+size_t mlx_lib_pair(const uint16_t *raw, const uint32_t *seq, size_t n, uint64_t *second);
+
+/*
+ * 按 mlx_lib_pair 的结果换算 m 帧：每帧两个子页经 mlx_frame_assembler_push，
+ * to 写入 m * 768 个温度，ta / vdd 可为 NULL。tr_fixed 为 0 时 tr = Ta - ta_shift。
+ * 返回拼接失败的帧数（正常为 0）。
+ */
+size_t mlx_lib_convert(const uint16_t *raw, const uint64_t *second, size_t m,
+                       const paramsMLX90640 *params, float emissivity, float ta_shift,
+                       int tr_fixed, float tr, float *to, float *ta, float *vdd);
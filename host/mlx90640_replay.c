@@ -0,0 +1,192 @@
+#include "mlx90640_replay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "MLX90640_I2C_Driver.h"
+#include "MLX90640_I2C_Capture.h"
+
+static uint8_t *log_buf;
+static size_t   log_len;
+static size_t   log_pos;
+static int      log_realtime;
+static mlx90640_replay_stats_t stats;
+
+/* ================= 日志读取 ================= */
+static size_t payload_words(const mlx90640_capture_rec_t *rec)
+{
+    if (rec->type == MLX90640_CAPTURE_WRITE) {
+        return 1;
+    }
+    if (rec->type == MLX90640_CAPTURE_READ && rec->result == 0) {
+        return rec->nWords;
+    }
+    return 0;
+}
+
+/* 解析 pos 处的记录，返回下一条记录的位置，越界返回 0 */
+static size_t peek(size_t pos, mlx90640_capture_rec_t *rec, const uint8_t **payload)
+{
+    if (pos + MLX90640_CAPTURE_REC_HDR > log_len) {
+        return 0;
+    }
+    MLX90640_CaptureDecodeRecord(log_buf + pos, rec);
+
+    size_t end = pos + MLX90640_CAPTURE_REC_HDR + 2 * payload_words(rec);
+    if (end > log_len) {
+        return 0;
+    }
+    *payload = log_buf + pos + MLX90640_CAPTURE_REC_HDR;
+    return end;
+}
+
+static void pace(uint32_t dt_us)
+{
+    stats.log_us += dt_us;
+    if (log_realtime && dt_us > 0) {
+        struct timespec ts = { dt_us / 1000000u, (long)(dt_us % 1000000u) * 1000 };
+        nanosleep(&ts, NULL);
+    }
+}
+
+/* 查找下一条匹配的记录；strict 时只看当前位置 */
+static int next_match(uint8_t type, uint16_t reg, uint16_t nWords, int strict,
+                      mlx90640_capture_rec_t *rec, const uint8_t **payload)
+{
+    size_t pos = log_pos;
+    uint32_t skipped = 0;
+
+    while (1) {
+        size_t next = peek(pos, rec, payload);
+        if (next == 0) {
+            return -1;
+        }
+        if (rec->type == type && rec->reg == reg && rec->nWords == nWords) {
+            if (skipped) {
+                stats.desync++;
+                stats.skipped += skipped;
+            }
+            stats.records++;
+            log_pos = next;
+            pace(rec->dt_us);
+            return 0;
+        }
+        if (strict) {
+            return 1;
+        }
+        skipped++;
+        pos = next;
+    }
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/* ================= 回放接口 ================= */
+int MLX90640_ReplayOpen(const char *path, int realtime)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return -1;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    MLX90640_ReplayClose();
+    log_buf = malloc(size > 0 ? (size_t)size : 1);
+    log_len = (log_buf && size > 0) ? fread(log_buf, 1, (size_t)size, f) : 0;
+    fclose(f);
+
+    /* 从串口保存的日志前面通常还有启动日志，向后找第一个有效的文件头 */
+    size_t start = 0;
+    while (start + MLX90640_CAPTURE_FILE_HDR <= log_len &&
+           MLX90640_CaptureDecodeFileHeader(log_buf + start) != 0) {
+        start++;
+    }
+    if (start + MLX90640_CAPTURE_FILE_HDR > log_len) {
+        MLX90640_ReplayClose();
+        return -1;
+    }
+
+    log_pos = start + MLX90640_CAPTURE_FILE_HDR;
+    log_realtime = realtime;
+    memset(&stats, 0, sizeof(stats));
+    return 0;
+}
+
+void MLX90640_ReplayClose(void)
+{
+    free(log_buf);
+    log_buf = NULL;
+    log_len = 0;
+    log_pos = 0;
+}
+
+int MLX90640_ReplayAtEnd(void)
+{
+    return log_pos + MLX90640_CAPTURE_REC_HDR > log_len;
+}
+
+void MLX90640_ReplayGetStats(mlx90640_replay_stats_t *s)
+{
+    *s = stats;
+}
+
+/* ================= MLX90640 I2C 驱动接口 ================= */
+int MLX90640_I2CInit(void)
+{
+    return log_buf ? 0 : -1;
+}
+
+int MLX90640_I2CGeneralReset(void)
+{
+    mlx90640_capture_rec_t rec;
+    const uint8_t *payload;
+
+    if (next_match(MLX90640_CAPTURE_RESET, 0, 0, 1, &rec, &payload) != 0) {
+        stats.desync++;
+        return 0;
+    }
+    return rec.result;
+}
+
+int MLX90640_I2CRead(uint8_t slaveAddr, uint16_t startAddress, uint16_t nWords, uint16_t *data)
+{
+    mlx90640_capture_rec_t rec;
+    const uint8_t *payload;
+    (void)slaveAddr;
+
+    if (next_match(MLX90640_CAPTURE_READ, startAddress, nWords, 0, &rec, &payload) != 0) {
+        return -1;      // 日志结束
+    }
+    if (rec.result != 0) {
+        return -1;      // 现场的总线错误照样回放
+    }
+
+    for (uint16_t i = 0; i < nWords; i++) {
+        data[i] = get16(payload + 2 * i);
+    }
+    return 0;
+}
+
+int MLX90640_I2CWrite(uint8_t slaveAddr, uint16_t writeAddress, uint16_t data)
+{
+    mlx90640_capture_rec_t rec;
+    const uint8_t *payload;
+    (void)slaveAddr;
+
+    if (next_match(MLX90640_CAPTURE_WRITE, writeAddress, 1, 1, &rec, &payload) != 0) {
+        stats.desync++;
+        return 0;
+    }
+    if (get16(payload) != data) {
+        stats.write_diff++;
+    }
+    return rec.result;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * 主机端 I2C 回放
+ *
+ * 读取 MLX90640_I2C_Capture 录制的日志，按记录顺序实现
+ * MLX90640_I2CRead/Write/GeneralReset。回放侧的调用顺序与录制时一致
+ * （例如都按 main.c 的 DumpEE → SetRefreshRate → GetFrameData 循环），
+ * GetFrameData 得到的帧与现场逐字节相同。
+ *
+ * 文件头之前的字节（例如串口上的启动日志）被跳过，从第一个 "MLXC" 文件头开始回放。
+ *
+ * 调用顺序不一致时，读操作向后查找下一条寄存器和长度都匹配的记录，
+ * 写操作不匹配时直接接受，两者都计入 desync。
+ *
+ * 构建（在仓库根目录）：
+ *   gcc -O2 -Imain -Ihost main/MLX90640_API.c main/MLX90640_I2C_Capture.c \
+ *       host/mlx90640_replay.c host/replay_bench.c -lm -o replay_bench
+ */
+
+typedef struct {
+    uint32_t records;       // 已消费的记录
+    uint32_t skipped;       // 为重新对齐跳过的记录
+    uint32_t desync;        // 与日志不一致的调用
+    uint32_t write_diff;    // 寄存器一致但写入值不同
+    uint64_t log_us;        // 日志中已回放的时长
+} mlx90640_replay_stats_t;
+
+int  MLX90640_ReplayOpen(const char *path, int realtime);
+void MLX90640_ReplayClose(void);
+int  MLX90640_ReplayAtEnd(void);
+void MLX90640_ReplayGetStats(mlx90640_replay_stats_t *stats);
@@ -0,0 +1,485 @@
+#include "mlx90640_sim.h"
+
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#include "MLX90640_I2C_Driver.h"
+#include "MLX90640_API.h"
+#include "MLX90640_I2C_Capture.h"
+
+/* ===== 寄存器布局 ===== */
+#define RAM_START       MLX90640_PIXEL_DATA_START_ADDRESS
+#define RAM_WORDS       (MLX90640_PIXEL_NUM + MLX90640_AUX_NUM)
+#define EE_START        MLX90640_EEPROM_START_ADDRESS
+#define EE_WORDS        MLX90640_EEPROM_DUMP_NUM
+
+#define CTRL_SUBPAGE_EN     BIT_MASK(0)
+#define CTRL_STEP_MODE      BIT_MASK(1)     // 1 = 只在触发后转换一个子页
+#define CTRL_DATA_HOLD      BIT_MASK(2)
+#define CTRL_SUBPAGE_REP    BIT_MASK(3)
+#define CTRL_DEFAULT        0x1901      // chess, 18 位, 2Hz, 子页模式
+
+/* aux 内偏移（frameData 下标 - 768） */
+#define AUX_VBE         0
+#define AUX_CP_SP0      8
+#define AUX_GAIN        10
+#define AUX_PTAT        32
+#define AUX_CP_SP1      40
+#define AUX_VDD         42
+
+#define VBE_NOMINAL     19000
+#define GAIN_RATIO      0.98f       // 实际增益 / EEPROM 增益
+#define CP_TARGET       0.5f        // 补偿后的 CP 残余
+
+static mlx90640_sim_config_t cfg;
+static mlx90640_sim_stats_t stats;
+static paramsMLX90640 params;
+static int initialized;
+
+static uint16_t ee[EE_WORDS];
+static uint16_t ram[RAM_WORDS];
+static uint16_t status_reg;
+static uint16_t ctrl_reg;
+
+static uint64_t next_conv_us;
+static uint64_t step_done_us;       // 非 0 表示触发的转换将在此刻完成
+static uint64_t realtime_base_us;
+static int      last_subpage = 1;
+static float    truth[MLX90640_PIXEL_NUM];
+static uint32_t rng;
+
+/* ================= 工具 ================= */
+static uint32_t lcg(void)
+{
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+}
+
+static float noise(float amplitude)
+{
+    return amplitude * ((float)(lcg() & 0xFFFF) / 32768.0f - 1.0f);
+}
+
+static uint64_t monotonic_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static uint16_t s16(int v)
+{
+    if (v > 32766)  v = 32766;      // 0x7FFF 是传感器的无效标记
+    if (v < -32768) v = -32768;
+    return (uint16_t)(int16_t)v;
+}
+
+static uint16_t nibbles(int n1, int n2, int n3, int n4)
+{
+    return (uint16_t)((n1 & 0xF) | ((n2 & 0xF) << 4) | ((n3 & 0xF) << 8) | ((n4 & 0xF) << 12));
+}
+
+static uint32_t subpage_period_us(void)
+{
+    int rate = (ctrl_reg & ~MLX90640_CTRL_REFRESH_MASK) >> MLX90640_CTRL_REFRESH_SHIFT;
+    return 2000000u >> rate;        // 0 = 0.5Hz ... 7 = 64Hz
+}
+
+/* ================= EEPROM 合成 ================= */
+
+/*
+ * 数值取自数据手册中的典型器件，按 ExtractParameters 的位域反向编码。
+ * 每像素字（0x2440 起）带少量伪随机的 offset / alpha / kta 残差，
+ * 并标记一个 outlier 像素，以便覆盖 BadPixelsCorrection。
+ */
+static void build_eeprom(void)
+{
+    memset(ee, 0, sizeof(ee));
+
+    ee[10] = 0x0000;                                // 标定模式：chess
+    ee[12] = CTRL_DEFAULT;
+
+    ee[16] = nibbles(0, 1, 1, 4);                   // occRem/Col/Row scale, alphaPTAT = 9
+    ee[17] = (uint16_t)(int16_t)-60;                // offset 参考
+    for (int i = 0; i < 6; i++) {
+        ee[18 + i] = nibbles(i - 2, 1 - i % 3, i % 2, -1);
+    }
+    for (int i = 0; i < 8; i++) {
+        ee[24 + i] = nibbles(i % 3 - 1, 1, -(i % 2), 2 - i % 4);
+    }
+
+    ee[32] = nibbles(0, 2, 2, 6);                   // accRem/Col/Row scale, alphaScale = 36
+    ee[33] = 8250;                                  // alpha 参考 ≈ 1.2e-7
+    for (int i = 0; i < 6; i++) {
+        ee[34 + i] = nibbles(1, -1, 2, 0);
+    }
+    for (int i = 0; i < 8; i++) {
+        ee[40 + i] = nibbles(-2, 3, 1, -1);
+    }
+
+    ee[48] = 5580;                                  // gainEE
+    ee[49] = 12273;                                 // vPTAT25
+    ee[50] = (uint16_t)((9 << 10) | 338);           // KvPTAT = 9/4096, KtPTAT = 42.25
+    ee[51] = 0x9D68;                                // kVdd = -3168, vdd25 = -13056
+    ee[52] = nibbles(4, 4, 4, 4);                   // Kv 四象限
+    ee[53] = (uint16_t)((1 << 11) | (4 << 6) | 2);  // ilChessC
+    ee[54] = (uint16_t)((80 << 8) | 76);            // KtaRC
+    ee[55] = (uint16_t)((78 << 8) | 74);
+    ee[56] = (uint16_t)(0x2000 | (3 << 8) | (6 << 4) | 2);  // 18 位, kvScale, ktaScale1/2
+    ee[57] = 34;                                    // CP alpha
+    ee[58] = (uint16_t)((2 << 10) | (1024 - 60));   // CP offset
+    ee[59] = (uint16_t)((4 << 8) | 66);             // cpKv, cpKta
+    ee[60] = (uint16_t)((0xF0 << 8) | 16);          // KsTa = -0.002, tgc = 0.5
+    ee[61] = 0x9797;                                // ksTo
+    ee[62] = 0x9797;
+    ee[63] = (uint16_t)((2 << 12) | (8 << 8) | (8 << 4) | 9);
+
+    rng = 0x2400;
+    for (int p = 0; p < MLX90640_PIXEL_NUM; p++) {
+        int offset = (int)(lcg() % 17) - 8;
+        int alpha  = (int)(lcg() % 21) - 10;
+        int kta    = (int)(lcg() % 5) - 2;
+        uint16_t w = (uint16_t)(((offset & 0x3F) << 10) | ((alpha & 0x3F) << 4) | ((kta & 0x7) << 1));
+        if (w == 0) {
+            w = 1 << 4;     // 全 0 表示坏点
+        }
+        ee[64 + p] = w;
+    }
+    ee[64 + 300] |= 0x0001;
+}
+
+/* ================= 场景与正向模型 ================= */
+static void render_scene(float t_s)
+{
+    float cx = 16.0f + 9.0f * cosf(t_s * 1.5708f);
+    float cy = 12.0f + 6.0f * sinf(t_s * 1.5708f);
+
+    for (int p = 0; p < MLX90640_PIXEL_NUM; p++) {
+        float x = (float)(p % MLX90640_COLUMN_NUM);
+        float y = (float)(p / MLX90640_COLUMN_NUM);
+        float d2 = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+
+        truth[p] = cfg.background + 2.0f * x / MLX90640_COLUMN_NUM
+                 + (cfg.blob_peak - cfg.background) * expf(-d2 / 18.0f)
+                 + noise(cfg.noise);
+    }
+}
+
+/* CalculateTo 的逆运算：给定目标温度求像素原始计数 */
+static int pixel_raw(int p, float to, float ta, float vdd, float gain,
+                     const float *irDataCP, int subPage, uint8_t mode)
+{
+    int ilPattern = p / 32 - (p / 64) * 2;
+    int conversionPattern = ((p + 2) / 4 - (p + 3) / 4 + (p + 1) / 4 - p / 4) * (1 - 2 * ilPattern);
+    float ktaScale = (float)POW2(params.ktaScale);
+    float kvScale = (float)POW2(params.kvScale);
+    float alphaScale = (float)POW2(params.alphaScale);
+
+    float ta4 = powf(ta + 273.15f, 4.0f);
+    float tr4 = powf(cfg.tr + 273.15f, 4.0f);
+    float taTr = tr4 - (tr4 - ta4) / cfg.emissivity;
+
+    float alphaComp = SCALEALPHA * alphaScale / params.alpha[p];
+    alphaComp = alphaComp * (1 + params.KsTa * (ta - 25));
+
+    int range = (to < params.ct[1]) ? 0 : (to < params.ct[2]) ? 1 : (to < params.ct[3]) ? 2 : 3;
+    float alphaCorrR[4];
+    alphaCorrR[0] = 1 / (1 + params.ksTo[0] * 40);
+    alphaCorrR[1] = 1;
+    alphaCorrR[2] = (1 + params.ksTo[1] * params.ct[2]);
+    alphaCorrR[3] = alphaCorrR[2] * (1 + params.ksTo[2] * (params.ct[3] - params.ct[2]));
+
+    float irData = alphaComp * alphaCorrR[range] * (1 + params.ksTo[range] * (to - params.ct[range]))
+                 * (powf(to + 273.15f, 4.0f) - taTr);
+    irData = irData * cfg.emissivity;
+    irData = irData + params.tgc * irDataCP[subPage];
+
+    if (mode != params.calibrationModeEE) {
+        irData = irData - params.ilChessC[2] * (2 * ilPattern - 1) + params.ilChessC[1] * conversionPattern;
+    }
+
+    float kta = params.kta[p] / ktaScale;
+    float kv = params.kv[p] / kvScale;
+    irData = irData + params.offset[p] * (1 + kta * (ta - 25)) * (1 + kv * (vdd - 3.3f));
+
+    return (int)lrintf(irData / gain);
+}
+
+static void convert_subpage(void)
+{
+    int subPage;
+    if (ctrl_reg & CTRL_SUBPAGE_REP) {
+        subPage = (ctrl_reg >> 4) & 0x1;
+    } else {
+        subPage = !last_subpage;
+    }
+
+    stats.conversions++;
+    if (MLX90640_GET_DATA_READY(status_reg)) {
+        stats.overruns++;
+        if (ctrl_reg & CTRL_DATA_HOLD) {
+            return;
+        }
+    }
+    last_subpage = subPage;
+
+    uint8_t mode = (ctrl_reg & MLX90640_CTRL_MEAS_MODE_MASK) >> 5;
+    int resRAM = (ctrl_reg & ~MLX90640_CTRL_RESOLUTION_MASK) >> MLX90640_CTRL_RESOLUTION_SHIFT;
+    float scale = ldexpf(1.0f, resRAM - params.resolutionEE);
+
+    float t_s = (float)stats.now_us / 1e6f;
+    float ta = cfg.ta + 0.2f * sinf(t_s * 0.05f);
+    float vdd = cfg.vdd + noise(0.002f);
+    render_scene(t_s);
+
+    /* ---- aux ---- */
+    uint16_t *aux = &ram[MLX90640_PIXEL_NUM];
+    int gainRAM = (int)lrintf(params.gainEE * GAIN_RATIO);
+    float gain = (float)params.gainEE / (int16_t)s16((int)(gainRAM * scale));
+
+    float ptatArt = ((ta - 25) * params.KtPTAT + params.vPTAT25) * (1 + params.KvPTAT * (vdd - 3.3f));
+    float ptat = ptatArt * VBE_NOMINAL / (262144.0f - ptatArt * params.alphaPTAT);
+
+    aux[AUX_VBE]  = VBE_NOMINAL;
+    aux[AUX_PTAT] = s16((int)lrintf(ptat));
+    aux[AUX_GAIN] = s16((int)(gainRAM * scale));
+    aux[AUX_VDD]  = s16((int)lrintf(((vdd - 3.3f) * params.kVdd + params.vdd25) / ldexpf(1.0f, params.resolutionEE - resRAM)));
+
+    /* 与库中 GetTa/GetVdd 对齐，消除量化误差 */
+    uint16_t frame[834];
+    memcpy(frame, ram, sizeof(ram));
+    frame[832] = ctrl_reg;
+    frame[833] = subPage;
+    vdd = MLX90640_GetVdd(frame, &params);
+    ta = MLX90640_GetTa(frame, &params);
+
+    float cpComp = (1 + params.cpKta * (ta - 25)) * (1 + params.cpKv * (vdd - 3.3f));
+    float cpOffset1 = params.cpOffset[1] + (mode != params.calibrationModeEE ? params.ilChessC[0] : 0);
+    int cp0 = (int)lrintf((CP_TARGET + params.cpOffset[0] * cpComp) / gain);
+    int cp1 = (int)lrintf((CP_TARGET + cpOffset1 * cpComp) / gain);
+    aux[AUX_CP_SP0] = s16(cp0);
+    aux[AUX_CP_SP1] = s16(cp1);
+
+    float irDataCP[2];
+    irDataCP[0] = (int16_t)aux[AUX_CP_SP0] * gain - params.cpOffset[0] * cpComp;
+    irDataCP[1] = (int16_t)aux[AUX_CP_SP1] * gain - cpOffset1 * cpComp;
+
+    /* ---- 像素：只写本子页对应的一半 ---- */
+    for (int p = 0; p < MLX90640_PIXEL_NUM; p++) {
+        int ilPattern = p / 32 - (p / 64) * 2;
+        int chessPattern = ilPattern ^ (p - (p / 2) * 2);
+        int pattern = mode ? chessPattern : ilPattern;
+        if (pattern != subPage) {
+            continue;
+        }
+        ram[p] = s16(pixel_raw(p, truth[p], ta, vdd, gain, irDataCP, subPage, mode));
+    }
+
+    status_reg = (uint16_t)((status_reg & ~0x000F) | MLX90640_STAT_DATA_READY_MASK | subPage);
+}
+
+/* ================= 仿真时钟 ================= */
+static void run_conversions(void)
+{
+    if (ctrl_reg & CTRL_STEP_MODE) {
+        if (step_done_us && stats.now_us >= step_done_us) {
+            step_done_us = 0;
+            convert_subpage();
+        }
+        /* 自由运行的节拍停在原地，退出 step 模式后从当前时刻重新开始 */
+        next_conv_us = stats.now_us + subpage_period_us();
+        return;
+    }
+
+    while (stats.now_us >= next_conv_us) {
+        convert_subpage();
+        next_conv_us += subpage_period_us();
+    }
+}
+
+static void advance(uint32_t words, int is_write)
+{
+    if (cfg.realtime) {
+        stats.now_us = monotonic_us() - realtime_base_us;
+    } else {
+        /* start + 地址 + 2 字节寄存器 (+ restart + 地址) + 数据，每字节 9 bit */
+        uint32_t bits = is_write ? (1 + 9 + 18 + 18 + 1) : (1 + 9 + 18 + 1 + 9 + 18 * words + 1);
+        stats.now_us += cfg.xfer_overhead_us + (uint64_t)bits * 1000000u / cfg.scl_hz;
+    }
+
+    run_conversions();
+}
+
+static uint16_t read_word(uint16_t addr)
+{
+    if (addr >= RAM_START && addr < RAM_START + RAM_WORDS) {
+        return ram[addr - RAM_START];
+    }
+    if (addr >= EE_START && addr < EE_START + EE_WORDS) {
+        return ee[addr - EE_START];
+    }
+    if (addr == MLX90640_STATUS_REG) {
+        return status_reg;
+    }
+    if (addr == MLX90640_CTRL_REG) {
+        return ctrl_reg;
+    }
+    return 0;
+}
+
+/* ================= 仿真器接口 ================= */
+void MLX90640_SimDefaultConfig(mlx90640_sim_config_t *c)
+{
+    memset(c, 0, sizeof(*c));
+    c->scl_hz           = 400000;
+    c->xfer_overhead_us = 20;
+    c->seed             = 1;
+    c->ta               = 30.0f;
+    c->vdd              = 3.3f;
+    c->background       = 24.0f;
+    c->blob_peak        = 36.0f;
+    c->noise            = 0.05f;
+    c->emissivity       = 0.95f;
+    c->tr               = c->ta - 8;
+}
+
+int MLX90640_SimInit(const mlx90640_sim_config_t *c)
+{
+    if (c) {
+        cfg = *c;
+    } else {
+        MLX90640_SimDefaultConfig(&cfg);
+    }
+
+    memset(&stats, 0, sizeof(stats));
+    memset(ram, 0, sizeof(ram));
+    build_eeprom();
+    rng = cfg.seed;
+
+    int error = MLX90640_ExtractParameters(ee, &params);
+    if (error != MLX90640_NO_ERROR) {
+        return error;
+    }
+
+    status_reg = 0;
+    ctrl_reg = CTRL_DEFAULT;
+    step_done_us = 0;
+    last_subpage = 1;
+    realtime_base_us = monotonic_us();
+    next_conv_us = subpage_period_us();
+    initialized = 1;
+
+    return 0;
+}
+
+void MLX90640_SimGetTruth(float *to)
+{
+    memcpy(to, truth, sizeof(truth));
+}
+
+void MLX90640_SimGetStats(mlx90640_sim_stats_t *s)
+{
+    *s = stats;
+}
+
+const uint16_t *MLX90640_SimEEPROM(void)
+{
+    return ee;
+}
+
+void MLX90640_SimSleep(uint64_t us)
+{
+    if (cfg.realtime) {
+        struct timespec ts = { (time_t)(us / 1000000u), (long)(us % 1000000u) * 1000 };
+        nanosleep(&ts, NULL);
+        stats.now_us = monotonic_us() - realtime_base_us;
+    } else {
+        stats.now_us += us;
+    }
+    stats.slept_us += us;
+    run_conversions();
+}
+
+uint64_t MLX90640_SimNow(void)
+{
+    if (cfg.realtime) {
+        stats.now_us = monotonic_us() - realtime_base_us;
+    }
+    return stats.now_us;
+}
+
+/* ================= MLX90640 I2C 驱动接口 ================= */
+int MLX90640_I2CInit(void)
+{
+    if (!initialized) {
+        return MLX90640_SimInit(NULL);
+    }
+    return 0;
+}
+
+int MLX90640_I2CGeneralReset(void)
+{
+    /* TriggerMeasurement：写 CTRL bit15 后由 general call reset 启动一次转换，bit15 自清 */
+    if ((ctrl_reg & MLX90640_CTRL_TRIG_READY_MASK) && !cfg.drop_general_call) {
+        ctrl_reg &= (uint16_t)~MLX90640_CTRL_TRIG_READY_MASK;
+        step_done_us = stats.now_us + subpage_period_us();
+        stats.triggers++;
+    }
+    MLX90640_I2C_CAPTURE_RECORD(MLX90640_CAPTURE_RESET, 0, 0, NULL, 0);
+    return 0;
+}
+
+int MLX90640_I2CRead(uint8_t slaveAddr, uint16_t startAddress, uint16_t nWords, uint16_t *data)
+{
+    (void)slaveAddr;
+
+    if (!initialized) {
+        return -1;
+    }
+
+    advance(nWords, 0);
+    stats.reads++;
+    stats.bytes += 2u * nWords;
+
+    for (uint16_t i = 0; i < nWords; i++) {
+        data[i] = read_word((uint16_t)(startAddress + i));
+    }
+
+    MLX90640_I2C_CAPTURE_RECORD(MLX90640_CAPTURE_READ, startAddress, nWords, data, 0);
+
+    return 0;
+}
+
+int MLX90640_I2CWrite(uint8_t slaveAddr, uint16_t writeAddress, uint16_t data)
+{
+    (void)slaveAddr;
+
+    if (!initialized) {
+        return -1;
+    }
+
+    advance(1, 1);
+    stats.writes++;
+    stats.bytes += 2;
+
+    if (writeAddress == MLX90640_STATUS_REG) {
+        /* 子页号只读；data-ready 只能被写 0 清除 */
+        uint16_t ready = status_reg & data & MLX90640_STAT_DATA_READY_MASK;
+        status_reg = (uint16_t)((data & ~0x000F) | (status_reg & 0x0007) | ready);
+    } else if (writeAddress == MLX90640_CTRL_REG) {
+        uint32_t old_period = subpage_period_us();
+        ctrl_reg = data;
+        if (subpage_period_us() != old_period) {
+            next_conv_us = stats.now_us + subpage_period_us();
+        }
+    } else if (writeAddress >= RAM_START && writeAddress < RAM_START + RAM_WORDS) {
+        ram[writeAddress - RAM_START] = data;
+    } else {
+        MLX90640_I2C_CAPTURE_RECORD(MLX90640_CAPTURE_WRITE, writeAddress, 1, &data, -1);
+        return -1;      // EEPROM 写入不在仿真范围内
+    }
+
+    MLX90640_I2C_CAPTURE_RECORD(MLX90640_CAPTURE_WRITE, writeAddress, 1, &data, 0);
+    return 0;
+}
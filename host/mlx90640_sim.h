@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * 主机端 MLX90640 仿真器
+ *
+ * 实现 MLX90640_I2C_Driver.h 的接口（I2CInit/I2CRead/I2CWrite/
+ * I2CGeneralReset），可在 Linux 上不接传感器运行完整的采集 + 标定流程：
+ *
+ *   - EEPROM：按 MLX90640_ExtractParameters 的编码规则合成的标定镜像
+ *   - 状态寄存器 0x8000：data-ready 与子页号随仿真时钟翻转
+ *   - 控制寄存器 0x800D：刷新率 / 分辨率 / chess-interleaved / 子页重复 /
+ *     step 模式（bit1，TriggerMeasurement 触发一次转换，耗时一个子页周期）
+ *   - 像素 RAM 与 aux：由合成场景反算出的原始 ADC 计数
+ *
+ * 仿真时钟默认是虚拟时间：每次 I2C 事务按总线速率推进，状态寄存器
+ * 轮询因此会在下一次转换完成时自然返回 ready，跑满 64Hz 也不需要真的等。
+ *
+ * 构建（在仓库根目录）：
+ *   gcc -O2 -Imain -Ihost main/MLX90640_API.c host/mlx90640_sim.c \
+ *       host/sim_bench.c -lm -o sim_bench
+ */
+
+typedef struct {
+    uint32_t scl_hz;            // 仿真总线速率，决定每次事务消耗的虚拟时间
+    uint32_t xfer_overhead_us;  // 每次事务的固定驱动开销
+    int      realtime;          // 1 = 使用单调时钟，轮询会真实等待
+    uint32_t seed;              // 场景噪声种子
+    int      drop_general_call; // 1 = 忽略 general call reset（模拟没送到总线），step 触发不会启动转换
+
+    /* 场景 */
+    float    ta;                // 传感器自身温度
+    float    vdd;
+    float    background;        // 背景温度
+    float    blob_peak;         // 移动热源峰值温度
+    float    noise;             // 每像素噪声幅度（°C）
+    float    emissivity;        // 与流水线中 CalculateTo 使用的参数一致时可无偏还原
+    float    tr;
+} mlx90640_sim_config_t;
+
+typedef struct {
+    uint64_t now_us;            // 仿真时钟
+    uint32_t conversions;       // 已完成的子页转换
+    uint32_t overruns;          // 未读取即被覆盖的子页
+    uint32_t reads;
+    uint32_t writes;
+    uint64_t bytes;
+    uint32_t triggers;          // step 模式下的触发次数
+    uint64_t slept_us;          // MLX90640_SimSleep 累计
+} mlx90640_sim_stats_t;
+
+void MLX90640_SimDefaultConfig(mlx90640_sim_config_t *cfg);
+int  MLX90640_SimInit(const mlx90640_sim_config_t *cfg);
+
+/* 返回最近一次子页转换所用的真值温度图（768 点） */
+void MLX90640_SimGetTruth(float *to);
+void MLX90640_SimGetStats(mlx90640_sim_stats_t *stats);
+const uint16_t *MLX90640_SimEEPROM(void);
+
+/* 主机侧睡眠：虚拟时钟直接前进（期间照常完成转换），实时模式真实睡眠 */
+void MLX90640_SimSleep(uint64_t us);
+uint64_t MLX90640_SimNow(void);
@@ -0,0 +1,242 @@
+#include "mlx_bus.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+static size_t slot_stride(void)
+{
+    return (sizeof(mlx_bus_slot_t) + 63) & ~(size_t)63;
+}
+
+static mlx_bus_slot_t *slot_at(const mlx_bus_shm_t *shm, uint64_t s)
+{
+    return (mlx_bus_slot_t *)((uint8_t *)shm + shm->header_size + (s % shm->slots) * shm->slot_size);
+}
+
+/* ================= 等待 / 唤醒 ================= */
+
+/* 共享映射上的 futex 不加 PRIVATE，跨进程有效；非 Linux 退化为短睡眠轮询 */
+static void notify_wake(mlx_bus_shm_t *shm)
+{
+    atomic_fetch_add_explicit(&shm->notify, 1, memory_order_release);
+#ifdef __linux__
+    syscall(SYS_futex, &shm->notify, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#endif
+}
+
+static void notify_wait(const mlx_bus_shm_t *shm, uint32_t seen, int timeout_ms)
+{
+#ifdef __linux__
+    struct timespec ts = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000L };
+    syscall(SYS_futex, &shm->notify, FUTEX_WAIT, seen, timeout_ms < 0 ? NULL : &ts, NULL, 0);
+#else
+    struct timespec ts = { 0, 1000000L };
+    (void)shm;
+    (void)seen;
+    (void)timeout_ms;
+    nanosleep(&ts, NULL);
+#endif
+}
+
+/* ================= 写端 ================= */
+int mlx_bus_create(mlx_bus_writer_t *w, const char *name, uint32_t slots)
+{
+    memset(w, 0, sizeof(*w));
+    if (slots < 2) {
+        errno = EINVAL;
+        return -1;
+    }
+    snprintf(w->name, sizeof(w->name), "%s", name);
+    w->size = sizeof(mlx_bus_shm_t) + slots * slot_stride();
+
+    /* 先删再建：旧总线的读端保留自己的映射，并会看到 closed */
+    shm_unlink(w->name);
+    int fd = shm_open(w->name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)w->size) != 0) {
+        close(fd);
+        shm_unlink(w->name);
+        return -1;
+    }
+    void *p = mmap(NULL, w->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        shm_unlink(w->name);
+        return -1;
+    }
+
+    w->shm = p;
+    w->shm->version = MLX_BUS_VERSION;
+    w->shm->header_size = sizeof(mlx_bus_shm_t);
+    w->shm->slots = slots;
+    w->shm->slot_size = (uint32_t)slot_stride();
+    w->shm->writer_pid = (int32_t)getpid();
+    atomic_thread_fence(memory_order_release);
+    w->shm->magic = MLX_BUS_MAGIC;      // 最后写 magic，读端看到它时其余字段已就绪
+    return 0;
+}
+
+void mlx_bus_publish(mlx_bus_writer_t *w, const mlx_frame_t *f)
+{
+    mlx_bus_shm_t *shm = w->shm;
+    uint64_t s = atomic_load_explicit(&shm->head, memory_order_relaxed) + 1;
+    mlx_bus_slot_t *slot = slot_at(shm, s);
+
+    atomic_store_explicit(&slot->bus_seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    slot->seq = f->seq;
+    slot->ctrl = f->ctrl;
+    slot->subpage = f->subpage;
+    slot->t_first_us = f->t_first_us;
+    slot->t_last_us = f->t_last_us;
+    slot->ta = f->ta;
+    slot->vdd = f->vdd;
+    memcpy(slot->to, f->to, sizeof(slot->to));
+
+    atomic_store_explicit(&slot->bus_seq, s, memory_order_release);
+    atomic_store_explicit(&shm->head, s, memory_order_release);
+    notify_wake(shm);
+}
+
+void mlx_bus_destroy(mlx_bus_writer_t *w)
+{
+    if (w->shm == NULL) {
+        return;
+    }
+    atomic_store_explicit(&w->shm->closed, 1, memory_order_release);
+    notify_wake(w->shm);
+    shm_unlink(w->name);
+    munmap(w->shm, w->size);
+    w->shm = NULL;
+}
+
+/* ================= 读端 ================= */
+int mlx_bus_attach(mlx_bus_reader_t *r, const char *name)
+{
+    struct stat st;
+
+    memset(r, 0, sizeof(*r));
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(mlx_bus_shm_t)) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        return -1;
+    }
+
+    const mlx_bus_shm_t *shm = p;
+    if (shm->magic != MLX_BUS_MAGIC || shm->version != MLX_BUS_VERSION || shm->slots < 2 ||
+        shm->slot_size < sizeof(mlx_bus_slot_t) ||
+        shm->header_size + (uint64_t)shm->slots * shm->slot_size > (uint64_t)st.st_size) {
+        munmap(p, (size_t)st.st_size);
+        errno = EINVAL;
+        return -1;
+    }
+    r->shm = shm;
+    r->size = (size_t)st.st_size;
+
+    uint64_t head = atomic_load_explicit(&shm->head, memory_order_acquire);
+    r->next = head ? head : 1;
+    return 0;
+}
+
+void mlx_bus_detach(mlx_bus_reader_t *r)
+{
+    if (r->shm) {
+        munmap((void *)r->shm, r->size);
+    }
+    memset(r, 0, sizeof(*r));
+}
+
+const mlx_bus_slot_t *mlx_bus_peek(mlx_bus_reader_t *r)
+{
+    const mlx_bus_shm_t *shm = r->shm;
+
+    for (;;) {
+        uint64_t head = atomic_load_explicit(&shm->head, memory_order_acquire);
+        if (r->next > head) {
+            return NULL;
+        }
+        /* 落后超过一圈：跳到最新一帧 */
+        if (head - r->next >= shm->slots) {
+            r->lost += head - r->next;
+            r->next = head;
+        }
+        const mlx_bus_slot_t *slot = slot_at(shm, r->next);
+        if (atomic_load_explicit(&slot->bus_seq, memory_order_acquire) == r->next) {
+            r->cur = slot;
+            return slot;
+        }
+        /* 刚被写端追上并正在改写，重新看 head */
+        r->overruns++;
+        r->next++;
+    }
+}
+
+int mlx_bus_done(mlx_bus_reader_t *r)
+{
+    const mlx_bus_slot_t *slot = r->cur;
+    int ok;
+
+    atomic_thread_fence(memory_order_acquire);
+    ok = atomic_load_explicit(&slot->bus_seq, memory_order_relaxed) == r->next;
+    r->cur = NULL;
+    r->next++;
+    if (!ok) {
+        r->overruns++;
+        return -1;
+    }
+    r->frames++;
+    return 0;
+}
+
+int mlx_bus_read(mlx_bus_reader_t *r, mlx_bus_slot_t *out)
+{
+    for (;;) {
+        const mlx_bus_slot_t *slot = mlx_bus_peek(r);
+        if (slot == NULL) {
+            return 0;
+        }
+        memcpy(out, slot, sizeof(*out));
+        if (mlx_bus_done(r) == 0) {
+            return 1;
+        }
+    }
+}
+
+int mlx_bus_wait(mlx_bus_reader_t *r, int timeout_ms)
+{
+    const mlx_bus_shm_t *shm = r->shm;
+    uint32_t seen = atomic_load_explicit(&shm->notify, memory_order_acquire);
+
+    if (atomic_load_explicit(&shm->head, memory_order_acquire) >= r->next) {
+        return 1;
+    }
+    if (atomic_load_explicit(&shm->closed, memory_order_acquire)) {
+        return -1;
+    }
+    notify_wait(shm, seen, timeout_ms);
+    return atomic_load_explicit(&shm->head, memory_order_acquire) >= r->next;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#include "mlx_frame.h"
+
+/*
+ * 主机端共享内存帧总线
+ *
+ * 串口只能被一个进程打开：mlx_busd 独占串口、解码一次，把整帧写进
+ * POSIX 共享内存（/dev/shm/<name>）里的环形缓冲区，查看器、记录器、告警等
+ * 任意多个本机进程各自只读映射后直接读槽位，不经过 socket、不拷贝。
+ *
+ *   头部   mlx_bus_shm_t（64 字节）
+ *   槽位   slots 个，每个 slot_size 字节（mlx_bus_slot_t 按 64 字节取整）
+ *
+ * 帧按发布顺序编号 1, 2, 3...，第 s 帧放在槽位 s % slots。
+ * 写端不等任何读端：每个槽位是一个 seqlock，写之前把 bus_seq 清 0，写完再置为 s；
+ * 读端在用数据前后各检查一次 bus_seq == s，不一致说明读的过程中被覆盖（overrun）。
+ * 读端落后超过 slots 帧时直接跳到最新一帧，跳过的帧计入 lost。
+ *
+ * Python 侧见 main/mlx_bus.py。
+ */
+
+#define MLX_BUS_MAGIC           0x42584C4Du     // "MLXB"
+#define MLX_BUS_VERSION         1
+#define MLX_BUS_DEFAULT_NAME    "/mlx90640"
+#define MLX_BUS_DEFAULT_SLOTS   64
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;       // 第一个槽位的偏移
+    uint32_t slots;
+    uint32_t slot_size;
+    int32_t  writer_pid;
+    _Atomic uint32_t closed;    // 写端已退出，读端应重新 attach
+    _Atomic uint32_t notify;    // 每发布一帧加 1，读端在上面 futex 等待
+    uint32_t reserved0;
+    _Atomic uint64_t head;      // 已发布的帧数（= 最新一帧的编号）
+    uint8_t  reserved[24];
+} mlx_bus_shm_t;
+
+typedef struct {
+    _Atomic uint64_t bus_seq;   // 0 = 正在写 / 空
+    uint32_t seq;               // 设备帧序号
+    uint16_t ctrl;
+    uint8_t  subpage;
+    uint8_t  reserved;
+    int64_t  t_first_us;
+    int64_t  t_last_us;
+    float    ta;
+    float    vdd;
+    float    to[MLX90640_PIXEL_NUM];
+} mlx_bus_slot_t;
+
+_Static_assert(sizeof(mlx_bus_shm_t) == 64, "bus header layout");
+_Static_assert(sizeof(mlx_bus_slot_t) == 40 + MLX90640_PIXEL_NUM * 4, "bus slot layout");
+
+/* ================= 写端（mlx_busd） ================= */
+typedef struct {
+    mlx_bus_shm_t *shm;
+    size_t   size;
+    char     name[64];
+} mlx_bus_writer_t;
+
+/* 创建（已存在则替换）共享内存，成功返回 0 */
+int  mlx_bus_create(mlx_bus_writer_t *w, const char *name, uint32_t slots);
+void mlx_bus_publish(mlx_bus_writer_t *w, const mlx_frame_t *f);
+/* 标记 closed、唤醒读端并删除名字，已映射的读端仍可读完剩余的帧 */
+void mlx_bus_destroy(mlx_bus_writer_t *w);
+
+/* ================= 读端 ================= */
+typedef struct {
+    const mlx_bus_shm_t *shm;
+    size_t   size;
+    uint64_t next;              // 下一帧的编号
+    const mlx_bus_slot_t *cur;  // peek 返回、尚未 done 的槽位
+    uint64_t frames;
+    uint64_t lost;              // 落后太多被跳过的帧
+    uint64_t overruns;          // 读的过程中被覆盖的帧
+} mlx_bus_reader_t;
+
+/* 只读映射，从最新一帧开始读。成功返回 0 */
+int  mlx_bus_attach(mlx_bus_reader_t *r, const char *name);
+void mlx_bus_detach(mlx_bus_reader_t *r);
+
+/*
+ * 零拷贝读：返回下一帧所在的槽位，没有新帧返回 NULL。
+ * 用完后必须调用 mlx_bus_done：返回 0 表示期间数据没被改写，-1 表示被覆盖、结果应丢弃。
+ */
+const mlx_bus_slot_t *mlx_bus_peek(mlx_bus_reader_t *r);
+int  mlx_bus_done(mlx_bus_reader_t *r);
+
+/* 拷贝读：成功返回 1，没有新帧返回 0 */
+int  mlx_bus_read(mlx_bus_reader_t *r, mlx_bus_slot_t *out);
+
+/* 等新帧：有新帧返回 1，超时返回 0，写端已退出且没有剩余帧返回 -1 */
+int  mlx_bus_wait(mlx_bus_reader_t *r, int timeout_ms);
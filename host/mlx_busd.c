@@ -0,0 +1,246 @@
+/*
+ * 共享内存帧总线守护进程（总线格式见 mlx_bus.h）
+ *
+ *   ./mlx_busd [-n 名字] [-s 槽位数] [-e 发射率] [-q] 串口设备|输入文件|-
+ *   ./mlx_busd -w [-n 名字]
+ *
+ *   -n    共享内存名，默认 /mlx90640（/dev/shm/mlx90640）
+ *   -s    环形缓冲区槽位数，默认 64（8Hz 下约 8 秒）
+ *   -e    raw 输出时主机端标定用的发射率，默认 0.95
+ *   -q    不打印周期统计
+ *   -w    读端模式：挂到总线上打印帧率、丢帧和覆盖次数（示例 / 自检用）
+ *
+ * 守护进程独占串口，mlx_host_feed 只解码一次（binary / delta / raw 任一种输出），
+ * 每个整帧发布到总线；读端进程数量不影响解码开销。
+ * 输入是字符设备时设为 raw 模式，设备拔出后每秒重试打开；普通文件读完即退出。
+ * 用 mlx_fakedev 的 pty 可以在没有硬件时测试。
+ *
+ * 构建（在仓库根目录）：
+ *   gcc -O2 -Imain -Ihost main/MLX90640_API.c main/mlx_frame.c main/mlx_proto.c \
+ *       host/mlx90640_host.c host/mlx_bus.c host/mlx_busd.c -lm -lrt -o mlx_busd
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "mlx90640_host.h"
+#include "mlx_bus.h"
+
+#define TA_SHIFT        8
+#define REPORT_S        5
+
+static mlx_host_t host;
+static mlx_bus_writer_t bus;
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig)
+{
+    stop = 1;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void publish(const mlx_frame_t *f, void *ctx)
+{
+    mlx_bus_publish(&bus, f);
+}
+
+/* ================= 输入 ================= */
+static int open_input(const char *path, int *is_device)
+{
+    struct stat st;
+
+    if (strcmp(path, "-") == 0) {
+        *is_device = 0;
+        return STDIN_FILENO;
+    }
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        return -1;
+    }
+    *is_device = fstat(fd, &st) == 0 && S_ISCHR(st.st_mode);
+    if (isatty(fd)) {
+        struct termios tio;
+        if (tcgetattr(fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            tio.c_cc[VMIN] = 1;
+            tio.c_cc[VTIME] = 0;
+            tcsetattr(fd, TCSANOW, &tio);
+        }
+    }
+    return fd;
+}
+
+static int run_daemon(const char *name, uint32_t slots, float emissivity, int quiet, const char *input)
+{
+    int is_device = 0;
+    int fd = open_input(input, &is_device);
+    if (fd < 0) {
+        perror(input);
+        return 1;
+    }
+    if (mlx_bus_create(&bus, name, slots) != 0) {
+        perror(name);
+        return 1;
+    }
+    mlx_host_init(&host, emissivity, TA_SHIFT);
+
+    struct sigaction sa = { .sa_handler = on_signal };
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    if (!quiet) {
+        fprintf(stderr, "bus %s: %u slots x %u bytes, input %s\n",
+                name, slots, bus.shm->slot_size, input);
+    }
+
+    static uint8_t buf[16384];
+    double t_report = now_s();
+    uint32_t frames_report = 0;
+    uint64_t bytes = 0;
+
+    while (!stop) {
+        ssize_t n = fd >= 0 ? read(fd, buf, sizeof(buf)) : -1;
+        if (n > 0) {
+            bytes += (uint64_t)n;
+            mlx_host_feed(&host, buf, (size_t)n, publish, NULL);
+        } else if (n < 0 && fd >= 0 && errno == EINTR) {
+            continue;
+        } else if (!is_device) {
+            break;                      // 文件 / 管道读完
+        } else {
+            /* 设备断开：关闭后每秒重试 */
+            if (fd >= 0) {
+                fprintf(stderr, "%s: disconnected\n", input);
+                close(fd);
+                fd = -1;
+                mlx_host_init(&host, emissivity, TA_SHIFT);
+            }
+            sleep(1);
+            if ((fd = open_input(input, &is_device)) >= 0) {
+                fprintf(stderr, "%s: reconnected\n", input);
+            }
+            is_device = 1;
+        }
+
+        double t = now_s();
+        if (!quiet && t - t_report >= REPORT_S) {
+            const mlx_host_stats_t *s = &host.stats;
+            fprintf(stderr, "published %llu (%.1f fps)  bytes %llu  bad %u  delta skipped %u  "
+                    "no calib %u  gaps %u",
+                    (unsigned long long)bus.shm->head, (s->frames - frames_report) / (t - t_report),
+                    (unsigned long long)bytes, s->bad, s->delta_skipped, s->no_calib, s->gaps);
+            if (s->metrics) {
+                /* 设备最近一次的 METRICS 包 */
+                fprintf(stderr, "  device cpu %u,%u%%  heap %u (min %u)", host.metrics.cpu_pct[0],
+                        host.metrics.cpu_pct[1], host.metrics.heap_free, host.metrics.heap_min_free);
+            }
+            fputc('\n', stderr);
+            frames_report = s->frames;
+            t_report = t;
+        }
+    }
+
+    if (!quiet) {
+        fprintf(stderr, "published %llu frames\n", (unsigned long long)bus.shm->head);
+    }
+    mlx_bus_destroy(&bus);
+    return 0;
+}
+
+/* ================= 读端 ================= */
+static int run_watch(const char *name)
+{
+    mlx_bus_reader_t r;
+
+    if (mlx_bus_attach(&r, name) != 0) {
+        perror(name);
+        return 1;
+    }
+    struct sigaction sa = { .sa_handler = on_signal };
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    double t_report = now_s();
+    uint64_t frames_report = 0;
+    float hi = 0.0f, ta = 0.0f;
+    uint32_t seq = 0;
+
+    while (!stop) {
+        int w = mlx_bus_wait(&r, 1000);
+        if (w < 0) {
+            fprintf(stderr, "bus closed by writer\n");
+            break;
+        }
+        const mlx_bus_slot_t *slot;
+        while ((slot = mlx_bus_peek(&r)) != NULL) {
+            /* 直接在共享内存上计算，done 确认期间没被覆盖 */
+            float m = slot->to[0];
+            for (int i = 1; i < MLX90640_PIXEL_NUM; i++) {
+                m = slot->to[i] > m ? slot->to[i] : m;
+            }
+            uint32_t s = slot->seq;
+            float t = slot->ta;
+            if (mlx_bus_done(&r) == 0) {
+                hi = m;
+                seq = s;
+                ta = t;
+            }
+        }
+
+        double t = now_s();
+        if (t - t_report >= 1.0) {
+            printf("frames %llu (%.1f fps)  lost %llu  overruns %llu  seq %u  Ta %.2f  max %.2f\n",
+                   (unsigned long long)r.frames, (r.frames - frames_report) / (t - t_report),
+                   (unsigned long long)r.lost, (unsigned long long)r.overruns, seq, ta, hi);
+            fflush(stdout);
+            frames_report = r.frames;
+            t_report = t;
+        }
+    }
+    mlx_bus_detach(&r);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *name = MLX_BUS_DEFAULT_NAME;
+    uint32_t slots = MLX_BUS_DEFAULT_SLOTS;
+    float emissivity = 0.95f;
+    int quiet = 0, watch = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:s:e:qw")) != -1) {
+        switch (opt) {
+        case 'n': name = optarg; break;
+        case 's': slots = (uint32_t)atoi(optarg); break;
+        case 'e': emissivity = (float)atof(optarg); break;
+        case 'q': quiet = 1; break;
+        case 'w': watch = 1; break;
+        default:
+            optind = argc + 1;
+            break;
+        }
+    }
+    if (watch && optind <= argc) {
+        return run_watch(name);
+    }
+    if (optind >= argc || slots < 2) {
+        fprintf(stderr, "usage: %s [-n name] [-s slots] [-e emissivity] [-q] device|file|-\n"
+                "       %s -w [-n name]\n", argv[0], argv[0]);
+        return 2;
+    }
+    return run_daemon(name, slots, emissivity, quiet, argv[optind]);
+}
@@ -0,0 +1,212 @@
+/*
+ * 假设备：仿真器采集 + 固件同样的编码，输出到 pty（或 stdout）
+ *
+ *   ./mlx_fakedev [-m frame|delta|raw] [-f 帧率] [-n 帧数] [-l 链接路径] [-]
+ *
+ *   -m    线上格式，对应 main.c 的 OUTPUT_BINARY / OUTPUT_DELTA / OUTPUT_RAW，默认 delta
+ *   -f    每秒整帧数（真实时间节拍），默认 8
+ *   -n    发送多少帧后退出，默认一直发
+ *   -l    额外建一个指向 pty 从端的符号链接，方便固定路径
+ *   -     不建 pty，直接写 stdout（可接管道：mlx_fakedev -n 100 - | mlx_busd -）
+ *
+ * 启动后在 stdout 打印 pty 从端路径，mlx_busd / raw_recv / Python 工具按串口打开即可。
+ * 从端由本进程先设为 raw 模式并保持打开；没有读端时 pty 写满就丢包（与 USB 口一致）。
+ *
+ * 构建（在仓库根目录）：
+ *   gcc -O2 -Imain -Ihost main/MLX90640_API.c main/mlx_frame.c main/mlx_proto.c main/mlx_delta.c \
+ *       host/mlx90640_sim.c host/mlx_fakedev.c -lm -o mlx_fakedev
+ */
+#define _XOPEN_SOURCE 700
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "MLX90640_I2C_Driver.h"
+#include "MLX90640_API.h"
+#include "mlx_frame.h"
+#include "mlx_proto.h"
+#include "mlx_delta.h"
+#include "mlx90640_sim.h"
+
+#define MLX90640_ADDR   0x33
+#define TA_SHIFT        8
+#define EMISSIVITY      0.95f
+#define CALIB_EVERY     256     // 与 main.c 相同：raw 模式每 256 个子页重发一次标定包
+
+enum { MODE_FRAME, MODE_DELTA, MODE_RAW };
+
+static paramsMLX90640 params;
+static uint16_t eeData[MLX90640_EEPROM_DUMP_NUM];
+static volatile sig_atomic_t stop;
+static int out_fd = STDOUT_FILENO;
+static uint64_t sent, dropped;
+
+static void on_signal(int sig)
+{
+    stop = 1;
+}
+
+/* 整包写出，写不下就丢（非阻塞 pty） */
+static void send_packet(const uint8_t *data, size_t len)
+{
+    size_t off = 0;
+    while (off < len) {
+        ssize_t n = write(out_fd, data + off, len - off);
+        if (n > 0) {
+            off += (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (off == 0 || stop) {
+            dropped++;
+            return;
+        } else {
+            /* 包写了一半：等读端腾出空间，保证流里不留半个包 */
+            struct timespec ts = { 0, 1000000L };
+            nanosleep(&ts, NULL);
+        }
+    }
+    sent++;
+}
+
+static int open_pty(const char *link_path)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        perror("posix_openpt");
+        return -1;
+    }
+    const char *slave_path = ptsname(master);
+
+    /* 从端先设 raw 并一直开着：否则行规程会改写二进制数据，且没有读端时主端写入报错 */
+    int slave = open(slave_path, O_RDWR | O_NOCTTY);
+    struct termios tio;
+    if (slave < 0 || tcgetattr(slave, &tio) != 0) {
+        perror(slave_path);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    if (link_path) {
+        unlink(link_path);
+        if (symlink(slave_path, link_path) != 0) {
+            perror(link_path);
+        }
+    }
+    printf("%s\n", slave_path);
+    fflush(stdout);
+    return master;
+}
+
+static void sleep_until(struct timespec *next, long period_ns)
+{
+    next->tv_nsec += period_ns;
+    while (next->tv_nsec >= 1000000000L) {
+        next->tv_nsec -= 1000000000L;
+        next->tv_sec++;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, next, NULL) == EINTR && !stop) {
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int mode = MODE_DELTA;
+    double fps = 8.0;
+    long limit = -1;
+    const char *link_path = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:f:n:l:")) != -1) {
+        switch (opt) {
+        case 'm':
+            mode = strcmp(optarg, "frame") == 0 ? MODE_FRAME :
+                   strcmp(optarg, "raw") == 0 ? MODE_RAW : MODE_DELTA;
+            break;
+        case 'f': fps = atof(optarg); break;
+        case 'n': limit = atol(optarg); break;
+        case 'l': link_path = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-m frame|delta|raw] [-f fps] [-n frames] [-l link] [-]\n", argv[0]);
+            return 2;
+        }
+    }
+    int to_stdout = optind < argc && strcmp(argv[optind], "-") == 0;
+    if (fps <= 0.0) {
+        fps = 8.0;
+    }
+
+    mlx90640_sim_config_t cfg;
+    MLX90640_SimDefaultConfig(&cfg);
+    if (MLX90640_SimInit(&cfg) != 0 || MLX90640_I2CInit() != 0 ||
+        MLX90640_DumpEE(MLX90640_ADDR, eeData) != 0 ||
+        MLX90640_ExtractParameters(eeData, &params) != 0) {
+        fprintf(stderr, "simulator init failed\n");
+        return 1;
+    }
+    MLX90640_SetRefreshRate(MLX90640_ADDR, 0x04);
+
+    if (!to_stdout && (out_fd = open_pty(link_path)) < 0) {
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    struct sigaction sa = { .sa_handler = on_signal };
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    static mlx_frame_assembler_t fa;
+    static mlx_delta_enc_t enc;
+    static mlx_raw_frame_t rf;
+    static mlx_frame_t frame;
+    static uint8_t wire[MLX_PROTO_WIRE_MAX(MLX_PROTO_RAW_SIZE)];
+    mlx_frame_assembler_init(&fa, &params, EMISSIVITY, TA_SHIFT);
+    mlx_delta_init(&enc);
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    long period_ns = (long)(1e9 / fps / 2);     // 每个子页
+    long frames = 0;
+
+    while (!stop && (limit < 0 || frames < limit)) {
+        if (MLX90640_GetFrameData(MLX90640_ADDR, rf.words) < 0) {
+            continue;
+        }
+        rf.t_us = (int64_t)MLX90640_SimNow();
+
+        if (mode == MODE_RAW) {
+            if (rf.seq % CALIB_EVERY == 0) {
+                send_packet(wire, mlx_proto_encode_calib(eeData, wire));
+            }
+            send_packet(wire, mlx_proto_encode_raw(&rf, wire));
+            if (rf.seq % 2 == 1) {
+                frames++;
+            }
+        } else if (mlx_frame_assembler_push(&fa, rf.words, rf.t_us, &frame)) {
+            size_t len = mode == MODE_DELTA ? mlx_delta_encode(&enc, &frame, MLX_DELTA_DEFAULT_KEY_INTERVAL, wire)
+                                            : mlx_proto_encode_frame(&frame, wire);
+            uint64_t before = dropped;
+            send_packet(wire, len);
+            if (dropped != before) {
+                mlx_delta_force_key(&enc);
+            }
+            frames++;
+        }
+        rf.seq++;
+        sleep_until(&next, period_ns);
+    }
+
+    fprintf(stderr, "%ld frames, %llu packets sent, %llu dropped\n",
+            frames, (unsigned long long)sent, (unsigned long long)dropped);
+    if (link_path) {
+        unlink(link_path);
+    }
+    return 0;
+}
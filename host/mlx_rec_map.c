@@ -0,0 +1,135 @@
+#include "mlx_rec_map.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static int parse(mlx_rec_map_t *m)
+{
+    const mlx_rec_header_t *h = (const mlx_rec_header_t *)m->base;
+
+    if (m->size < sizeof(*h) || memcmp(h->magic, MLX_REC_MAGIC, 4) != 0 ||
+        h->version != MLX_REC_VERSION || h->header_size > m->size ||
+        h->header_size < mlx_rec_header_size(h->ee_words) ||
+        h->record_size != mlx_rec_record_size(h->contents)) {
+        return -1;
+    }
+    m->hdr = h;
+    m->ee = h->ee_words ? (const uint16_t *)(m->base + sizeof(*h)) : NULL;
+
+    /* 尾部：magic 对得上且各段长度与文件长度吻合才采用；完整的文件长度总是 16 字节的倍数 */
+    if (m->size >= h->header_size + sizeof(mlx_rec_footer_t) && m->size % MLX_REC_ALIGN == 0) {
+        const mlx_rec_footer_t *ft = (const mlx_rec_footer_t *)(m->base + m->size - sizeof(*ft));
+        uint64_t data_end = h->header_size + ft->records * h->record_size;
+        if (memcmp(ft->magic, MLX_REC_FOOTER_MAGIC, 4) == 0 && ft->index_offset == data_end &&
+            data_end + (uint64_t)ft->entries * sizeof(mlx_rec_index_t) + sizeof(*ft) == m->size &&
+            ft->stride > 0) {
+            m->records = ft->records;
+            m->index = (const mlx_rec_index_t *)(m->base + data_end);
+            m->entries = ft->entries;
+            m->stride = ft->stride;
+            return 0;
+        }
+    }
+
+    m->records = (m->size - h->header_size) / h->record_size;
+    m->truncated = 1;
+    return 0;
+}
+
+int mlx_rec_open(const char *path, mlx_rec_map_t *m)
+{
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+
+    memset(m, 0, sizeof(*m));
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return -1;
+    }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        return -1;
+    }
+    m->base = p;
+    m->size = (size_t)st.st_size;
+
+    if (parse(m) != 0) {
+        mlx_rec_close(m);
+        return -1;
+    }
+    return 0;
+}
+
+void mlx_rec_close(mlx_rec_map_t *m)
+{
+    if (m->base) {
+        munmap((void *)m->base, m->size);
+    }
+    memset(m, 0, sizeof(*m));
+}
+
+const mlx_rec_record_t *mlx_rec_record(const mlx_rec_map_t *m, uint64_t i)
+{
+    return (const mlx_rec_record_t *)(m->base + m->hdr->header_size + i * m->hdr->record_size);
+}
+
+const uint16_t *mlx_rec_raw(const mlx_rec_map_t *m, uint64_t i)
+{
+    if (!(m->hdr->contents & MLX_REC_RAW)) {
+        return NULL;
+    }
+    return (const uint16_t *)(mlx_rec_record(m, i) + 1);
+}
+
+const int16_t *mlx_rec_centi(const mlx_rec_map_t *m, uint64_t i)
+{
+    if (!(m->hdr->contents & MLX_REC_CENTI)) {
+        return NULL;
+    }
+    const uint8_t *p = (const uint8_t *)(mlx_rec_record(m, i) + 1);
+    if (m->hdr->contents & MLX_REC_RAW) {
+        p += MLX_RAW_WORDS * 2;
+    }
+    return (const int16_t *)p;
+}
+
+uint64_t mlx_rec_seek(const mlx_rec_map_t *m, int64_t t_us)
+{
+    uint64_t lo = 0, hi = m->records;
+
+    /* 索引项 i 对应记录 i * stride，先缩小到相邻两项之间 */
+    if (m->index && m->entries) {
+        uint32_t a = 0, b = m->entries;
+        while (a < b) {
+            uint32_t mid = a + (b - a) / 2;
+            if (m->index[mid].t_us < t_us) {
+                a = mid + 1;
+            } else {
+                b = mid;
+            }
+        }
+        if (a > 0) {
+            lo = m->index[a - 1].record + 1;
+        }
+        if (a < m->entries) {
+            hi = m->index[a].record;
+        }
+    }
+
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (mlx_rec_record(m, mid)->t_us < t_us) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "mlx_rec.h"
+
+/*
+ * 主机端录制文件读取（格式见 main/mlx_rec.h）
+ *
+ * 整个文件只读 mmap，记录按下标直接取指针，不拷贝；
+ * 按时间定位先查稀疏索引，再在相邻两项之间按记录时间戳二分。
+ * 尾部缺失的文件（录制中断）照样可以打开，只是没有索引（全程二分）。
+ *
+ * 与 main/mlx_rec.c 一起编译（共用记录大小的计算）。
+ */
+
+typedef struct {
+    const uint8_t *base;
+    size_t   size;
+    const mlx_rec_header_t *hdr;
+    const uint16_t *ee;             // 没有标定数据时为 NULL
+    uint64_t records;
+    const mlx_rec_index_t *index;   // 没有尾部时为 NULL
+    uint32_t entries;
+    uint32_t stride;
+    int      truncated;             // 尾部缺失，记录数按文件长度推算
+} mlx_rec_map_t;
+
+/* 成功返回 0，文件不是录制文件返回 -1 */
+int  mlx_rec_open(const char *path, mlx_rec_map_t *m);
+void mlx_rec_close(mlx_rec_map_t *m);
+
+const mlx_rec_record_t *mlx_rec_record(const mlx_rec_map_t *m, uint64_t i);
+
+/* 记录载荷，不含对应内容时返回 NULL */
+const uint16_t *mlx_rec_raw(const mlx_rec_map_t *m, uint64_t i);
+const int16_t  *mlx_rec_centi(const mlx_rec_map_t *m, uint64_t i);
+
+/* 第一条 t_us >= t 的记录下标，全部更早时返回 records */
+uint64_t mlx_rec_seek(const mlx_rec_map_t *m, int64_t t_us);
@@ -0,0 +1,95 @@
+/*
+ * 接收 raw 输出流并在主机上计算温度（binary / delta 输出的整帧同样能解出来）
+ *
+ *   ./raw_recv [-c] [-e 发射率] [输入]
+ *
+ *   输入  线上字节流文件或串口设备（先 stty -F 设备 raw），默认 stdin
+ *   -c    每帧输出 768 个温度的 CSV 行，否则输出一行摘要
+ *   -e    发射率，默认 0.95（与 main.c 一致）
+ *
+ * 设备的 METRICS 包按固件日志的 METRICS 行格式打印到 stderr，
+ * 结束时在 stderr 打印包统计（见 mlx90640_host.h）。
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mlx90640_host.h"
+
+#define TA_SHIFT        8
+
+static mlx_host_t host;
+
+static void print_summary(const mlx_frame_t *f, void *ctx)
+{
+    float lo = f->to[0], hi = f->to[0];
+    for (int i = 1; i < MLX90640_PIXEL_NUM; i++) {
+        lo = f->to[i] < lo ? f->to[i] : lo;
+        hi = f->to[i] > hi ? f->to[i] : hi;
+    }
+    printf("frame %u t=%lld us Ta=%.2f Vdd=%.3f min=%.2f max=%.2f center=%.2f\n",
+           f->seq, (long long)f->t_last_us, f->ta, f->vdd, lo, hi, f->to[12 * 32 + 16]);
+}
+
+static void print_csv(const mlx_frame_t *f, void *ctx)
+{
+    for (int i = 0; i < MLX90640_PIXEL_NUM; i++) {
+        printf(i ? ",%.2f" : "%.2f", f->to[i]);
+    }
+    putchar('\n');
+}
+
+/* 与 mlx_sysmon_emit 的 METRICS 行格式一致 */
+static void print_metrics(const mlx_sysmon_record_t *rec, void *ctx)
+{
+    fprintf(stderr, "METRICS t=%u cpu=%u,%u heap=%u/%u/%u psram=%u", rec->uptime_ms,
+            rec->cpu_pct[0], rec->cpu_pct[1], rec->heap_free, rec->heap_min_free,
+            rec->heap_largest, rec->psram_free);
+    for (int i = 0; i < rec->ntasks; i++) {
+        const mlx_sysmon_task_t *t = &rec->tasks[i];
+        char core = (t->core == MLX_SYSMON_NO_CORE) ? '*' : (char)('0' + t->core);
+        fprintf(stderr, " %s:%c:%u:%u", t->name, core, t->cpu_pct, t->stack_free);
+    }
+    fputc('\n', stderr);
+}
+
+int main(int argc, char **argv)
+{
+    float emissivity = 0.95f;
+    int csv = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "ce:")) != -1) {
+        switch (opt) {
+        case 'c': csv = 1; break;
+        case 'e': emissivity = (float)atof(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-c] [-e emissivity] [input]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    FILE *in = stdin;
+    if (optind < argc && strcmp(argv[optind], "-") != 0 && (in = fopen(argv[optind], "rb")) == NULL) {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    mlx_host_init(&host, emissivity, TA_SHIFT);
+    host.on_metrics = print_metrics;
+
+    static uint8_t buf[16384];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+        mlx_host_feed(&host, buf, n, csv ? print_csv : print_summary, NULL);
+        fflush(stdout);
+    }
+
+    const mlx_host_stats_t *s = &host.stats;
+    fprintf(stderr, "packets %u (bad %u, other %u)  calib %u  raw %u (no calib %u, gaps %u)  "
+            "frames %u (delta skipped %u)  metrics %u\n",
+            s->packets, s->bad, s->other, s->calib, s->raw, s->no_calib, s->gaps, s->frames,
+            s->delta_skipped, s->metrics);
+    return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * 把 raw 输出流录成录制文件（格式见 main/mlx_rec.h）
+ *
+ *   ./rec_capture [-t] [-e 发射率] [-i 索引项数] 输出.rec [输入]
+ *
+ *   输入  线上字节流文件或串口设备（先 stty -F 设备 raw），默认 stdin
+ *   -t    录主机算好的整帧温度（CENTI），默认录原始子页（RAW）
+ *   -e    发射率，写入文件头并用于 -t 的计算，默认 0.95
+ *   -i    稀疏索引的最大项数，默认 4096
+ *
+ * 收到第一个标定包之后才开始写文件，文件头里的刷新率 / 分辨率 / 模式
+ * 取自第一个子页的控制寄存器。Ctrl-C 结束时写入索引和尾部。
+ *
+ * 构建（在仓库根目录）：
+ *   gcc -O2 -Imain -Ihost main/MLX90640_API.c main/mlx_frame.c main/mlx_proto.c \
+ *       main/mlx_rec.c host/mlx90640_host.c host/rec_capture.c -lm -o rec_capture
+ */
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mlx90640_host.h"
+#include "mlx_rec.h"
+
+#define TA_SHIFT        8
+
+static mlx_host_t host;
+static mlx_rec_writer_t rec;
+static mlx_rec_config_t rec_cfg;
+static mlx_rec_index_t *rec_index;
+static uint32_t index_cap = 4096;
+static FILE *out;
+static int started;
+static volatile sig_atomic_t stop;
+
+static size_t write_file(const void *data, size_t len, void *ctx)
+{
+    return fwrite(data, 1, len, (FILE *)ctx);
+}
+
+/* 第一个已标定的子页到达时写文件头 */
+static int ensure_started(const uint16_t *ctrl_frame)
+{
+    if (started || !host.have_calib) {
+        return started;
+    }
+    uint16_t ctrl = ctrl_frame[832];
+    rec_cfg.refresh_rate = (ctrl >> 7) & 0x7;
+    rec_cfg.resolution = (ctrl >> 10) & 0x3;
+    rec_cfg.pattern = (ctrl >> 12) & 0x1;
+    if (mlx_rec_begin(&rec, &rec_cfg, host.ee, rec_index, index_cap, write_file, out) != 0) {
+        perror("write");
+        exit(1);
+    }
+    started = 1;
+    return 1;
+}
+
+static void on_raw(const mlx_raw_frame_t *rf, void *ctx)
+{
+    if ((rec_cfg.contents & MLX_REC_RAW) && ensure_started(rf->words)) {
+        mlx_rec_put(&rec, rf, NULL);
+    }
+}
+
+static void on_frame(const mlx_frame_t *f, void *ctx)
+{
+    if ((rec_cfg.contents & MLX_REC_CENTI) && ensure_started(host.raw.words)) {
+        mlx_rec_put(&rec, NULL, f);
+    }
+}
+
+static void on_signal(int sig)
+{
+    stop = 1;
+}
+
+int main(int argc, char **argv)
+{
+    int opt;
+
+    rec_cfg.contents = MLX_REC_RAW;
+    rec_cfg.emissivity = 0.95f;
+    rec_cfg.ta_shift = TA_SHIFT;
+
+    while ((opt = getopt(argc, argv, "te:i:")) != -1) {
+        switch (opt) {
+        case 't': rec_cfg.contents = MLX_REC_CENTI; break;
+        case 'e': rec_cfg.emissivity = (float)atof(optarg); break;
+        case 'i': index_cap = (uint32_t)atoi(optarg); break;
+        default:
+            optind = argc;
+            break;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-t] [-e emissivity] [-i index] out.rec [input]\n", argv[0]);
+        return 2;
+    }
+
+    if ((out = fopen(argv[optind], "wb")) == NULL) {
+        perror(argv[optind]);
+        return 1;
+    }
+    FILE *in = stdin;
+    if (optind + 1 < argc && (in = fopen(argv[optind + 1], "rb")) == NULL) {
+        perror(argv[optind + 1]);
+        return 1;
+    }
+    rec_index = calloc(index_cap, sizeof(*rec_index));
+
+    mlx_host_init(&host, rec_cfg.emissivity, rec_cfg.ta_shift);
+    host.on_raw = on_raw;
+
+    struct sigaction sa = { .sa_handler = on_signal };
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    static uint8_t buf[16384];
+    size_t n;
+    while (!stop && (n = fread(buf, 1, sizeof(buf), in)) > 0) {
+        mlx_host_feed(&host, buf, n, on_frame, NULL);
+    }
+
+    if (started && mlx_rec_end(&rec) != 0) {
+        perror("write");
+    }
+    fclose(out);
+
+    fprintf(stderr, "%llu records (%s), index %u x stride %u, %llu bytes\n",
+            (unsigned long long)rec.records, rec_cfg.contents == MLX_REC_RAW ? "raw" : "centi",
+            rec.index_len, rec.stride, (unsigned long long)rec.offset);
+    return 0;
+}
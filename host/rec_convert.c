@@ -0,0 +1,309 @@
+/*
+ * 把 RAW 录制文件（rec_capture 录的原始子页）批量转成温度
+ *
+ *   ./rec_convert [-j 线程数] [-e 发射率] [-b] 输入.rec [输出目录]
+ *
+ *   -j    工作线程数，默认 CPU 核数
+ *   -e    覆盖文件头里的发射率
+ *   -b    依次用 1..j 个线程各跑一遍，打印帧率和加速比（不写输出）
+ *
+ * 计算与固件完全相同：每帧两个子页经 mlx_frame_assembler_push
+ * （MLX90640_CalculateTo + MLX90640_BadPixelsCorrection），标定参数取自文件头的 EEPROM 镜像。
+ *
+ * 子页配对直接调用 mlx90640_host.c 的 mlx_host_pair_push（与实时接收同一份规则），
+ * 先单线程扫一遍记录头把帧边界定下来，之后每一帧只依赖自己的两个子页，
+ * 按帧均分给各线程，互不通信；结果与顺序处理逐位相同，输出顺序不变。
+ *
+ * 输出目录里每列一个 .npy 文件（numpy.load(..., mmap_mode="r") 直接打开）：
+ *   to.npy    float32 (N, 24, 32)   线程直接写进 mmap 的文件
+ *   t_us.npy  int64   (N,)          第二个子页的设备时间
+ *   seq.npy   uint32  (N,)          第二个子页的子页序号
+ *   ta.npy / vdd.npy  float32 (N,)
+ *
+ * 构建（在仓库根目录）：
+ *   gcc -O2 -pthread -Imain -Ihost main/MLX90640_API.c main/mlx_frame.c main/mlx_proto.c \
+ *       main/mlx_rec.c host/mlx90640_host.c host/mlx_rec_map.c host/rec_convert.c -lm -o rec_convert
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mlx_frame.h"
+#include "mlx_rec_map.h"
+#include "mlx90640_host.h"
+
+#define MAX_THREADS     256
+
+static mlx_rec_map_t rec;
+static paramsMLX90640 params;
+static float emissivity;
+
+/* 帧 k 的第二个子页是记录 frame_rec[k]，第一个是 frame_rec[k] - 1 */
+static uint64_t *frame_rec;
+static uint64_t frames;
+
+/* 输出列 */
+static float   *col_to;
+static int64_t *col_t_us;
+static uint32_t *col_seq;
+static float   *col_ta;
+static float   *col_vdd;
+
+typedef struct {
+    pthread_t thread;
+    uint64_t first;
+    uint64_t last;
+    uint64_t failed;
+} worker_t;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ================= 帧边界 ================= */
+
+/* 与实时接收（mlx_host_push_raw）用同一个 mlx_host_pair_push 定帧边界 */
+static uint64_t scan_frames(void)
+{
+    mlx_host_pair_t pair;
+    uint64_t n = 0;
+
+    mlx_host_pair_reset(&pair);
+    frame_rec = malloc((rec.records / 2 + 1) * sizeof(*frame_rec));
+    for (uint64_t i = 0; i < rec.records; i++) {
+        if (mlx_host_pair_push(&pair, mlx_rec_record(&rec, i)->seq, mlx_rec_raw(&rec, i))) {
+            frame_rec[n++] = i;
+        }
+    }
+    return n;
+}
+
+/* ================= 计算 ================= */
+static void *worker(void *arg)
+{
+    worker_t *w = arg;
+    mlx_frame_assembler_t fa;
+    mlx_frame_t out;
+    uint16_t words[MLX_RAW_WORDS];
+
+    mlx_frame_assembler_init(&fa, &params, emissivity, rec.hdr->ta_shift / 100.0f);
+    fa.tr_fixed = rec.hdr->tr_fixed;
+    fa.tr = rec.hdr->tr / 100.0f;
+
+    for (uint64_t k = w->first; k < w->last; k++) {
+        uint64_t i = frame_rec[k];
+
+        mlx_frame_assembler_reset(&fa);
+        memcpy(words, mlx_rec_raw(&rec, i - 1), sizeof(words));
+        mlx_frame_assembler_push(&fa, words, mlx_rec_record(&rec, i - 1)->t_us, &out);
+        memcpy(words, mlx_rec_raw(&rec, i), sizeof(words));
+        if (!mlx_frame_assembler_push(&fa, words, mlx_rec_record(&rec, i)->t_us, &out)) {
+            w->failed++;
+            continue;
+        }
+
+        if (col_to) {
+            memcpy(col_to + k * MLX90640_PIXEL_NUM, out.to, sizeof(out.to));
+            col_t_us[k] = out.t_last_us;
+            col_seq[k] = mlx_rec_record(&rec, i)->seq;
+            col_ta[k] = out.ta;
+            col_vdd[k] = out.vdd;
+        }
+    }
+    return NULL;
+}
+
+/* 返回耗时（秒） */
+static double run(int threads)
+{
+    static worker_t workers[MAX_THREADS];
+    uint64_t failed = 0;
+    double t0 = now_s();
+
+    for (int t = 0; t < threads; t++) {
+        workers[t].first = frames * t / threads;
+        workers[t].last = frames * (t + 1) / threads;
+        workers[t].failed = 0;
+        pthread_create(&workers[t].thread, NULL, worker, &workers[t]);
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(workers[t].thread, NULL);
+        failed += workers[t].failed;
+    }
+    if (failed) {
+        fprintf(stderr, "warning: %llu frames failed to assemble\n", (unsigned long long)failed);
+    }
+    return now_s() - t0;
+}
+
+/* ================= .npy 输出 ================= */
+
+/* 写 NPY 1.0 头，返回头长度（数据从此处开始，64 字节对齐） */
+static size_t npy_header(FILE *f, const char *descr, const char *shape)
+{
+    char dict[128];
+    int n = snprintf(dict, sizeof(dict), "{'descr': '%s', 'fortran_order': False, 'shape': %s, }",
+                     descr, shape);
+    size_t total = (10 + (size_t)n + 1 + 63) & ~(size_t)63;
+    uint16_t hlen = (uint16_t)(total - 10);
+
+    fwrite("\x93NUMPY\x01\x00", 1, 8, f);
+    fputc(hlen & 0xFF, f);
+    fputc(hlen >> 8, f);
+    fwrite(dict, 1, (size_t)n, f);
+    for (size_t i = 10 + (size_t)n; i < total - 1; i++) {
+        fputc(' ', f);
+    }
+    fputc('\n', f);
+    return total;
+}
+
+static int write_column(const char *dir, const char *name, const char *descr,
+                        const void *data, size_t elem)
+{
+    char path[4096], shape[32];
+    snprintf(path, sizeof(path), "%s/%s.npy", dir, name);
+    snprintf(shape, sizeof(shape), "(%llu,)", (unsigned long long)frames);
+
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    npy_header(f, descr, shape);
+    size_t n = fwrite(data, elem, frames, f);
+    if (fclose(f) != 0 || n != frames) {
+        perror(path);
+        return -1;
+    }
+    return 0;
+}
+
+/* to.npy 预先分配好并 mmap，工作线程直接写到最终位置 */
+static int map_to_column(const char *dir, void **map, size_t *map_len)
+{
+    char path[4096], shape[64];
+    snprintf(path, sizeof(path), "%s/to.npy", dir);
+    snprintf(shape, sizeof(shape), "(%llu, 24, 32)", (unsigned long long)frames);
+
+    FILE *f = fopen(path, "wb+");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    size_t hdr = npy_header(f, "<f4", shape);
+    fflush(f);
+
+    *map_len = hdr + frames * MLX90640_PIXEL_NUM * sizeof(float);
+    if (ftruncate(fileno(f), (off_t)*map_len) != 0) {
+        perror(path);
+        fclose(f);
+        return -1;
+    }
+    *map = mmap(NULL, *map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fileno(f), 0);
+    fclose(f);
+    if (*map == MAP_FAILED) {
+        perror(path);
+        return -1;
+    }
+    col_to = (float *)((uint8_t *)*map + hdr);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    float e_override = 0.0f;
+    int bench = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "j:e:b")) != -1) {
+        switch (opt) {
+        case 'j': threads = atoi(optarg); break;
+        case 'e': e_override = (float)atof(optarg); break;
+        case 'b': bench = 1; break;
+        default:
+            optind = argc;
+            break;
+        }
+    }
+    if (optind >= argc || threads < 1 || threads > MAX_THREADS) {
+        fprintf(stderr, "usage: %s [-j threads] [-e emissivity] [-b] in.rec [out_dir]\n", argv[0]);
+        return 2;
+    }
+    const char *out_dir = optind + 1 < argc ? argv[optind + 1] : NULL;
+
+    if (mlx_rec_open(argv[optind], &rec) != 0) {
+        fprintf(stderr, "%s: not a recording\n", argv[optind]);
+        return 1;
+    }
+    if (!(rec.hdr->contents & MLX_REC_RAW) || rec.ee == NULL) {
+        fprintf(stderr, "%s: no raw subpages or calibration data\n", argv[optind]);
+        return 1;
+    }
+    static uint16_t ee[MLX90640_EEPROM_DUMP_NUM];
+    memcpy(ee, rec.ee, sizeof(ee));
+    if (MLX90640_ExtractParameters(ee, &params) != 0) {
+        fprintf(stderr, "%s: bad calibration data\n", argv[optind]);
+        return 1;
+    }
+    emissivity = e_override > 0.0f ? e_override : rec.hdr->emissivity / 10000.0f;
+
+    double t0 = now_s();
+    frames = scan_frames();
+    fprintf(stderr, "%llu subpages -> %llu frames%s (scan %.3f s)\n",
+            (unsigned long long)rec.records, (unsigned long long)frames,
+            rec.truncated ? ", truncated recording" : "", now_s() - t0);
+
+    if (bench) {
+        double base = 0.0;
+        for (int t = 1; t <= threads; t++) {
+            double s = run(t);
+            base = t == 1 ? s : base;
+            fprintf(stderr, "%3d threads  %10.0f frames/s  x%.2f\n", t, frames / s, base / s);
+        }
+        return 0;
+    }
+
+    void *map = NULL;
+    size_t map_len = 0;
+    if (out_dir) {
+        if (mkdir(out_dir, 0777) != 0 && errno != EEXIST) {
+            perror(out_dir);
+            return 1;
+        }
+        if (map_to_column(out_dir, &map, &map_len) != 0) {
+            return 1;
+        }
+        col_t_us = malloc(frames * sizeof(*col_t_us));
+        col_seq = malloc(frames * sizeof(*col_seq));
+        col_ta = malloc(frames * sizeof(*col_ta));
+        col_vdd = malloc(frames * sizeof(*col_vdd));
+    }
+
+    double s = run(threads);
+    fprintf(stderr, "%d threads: %llu frames in %.3f s, %.0f frames/s\n",
+            threads, (unsigned long long)frames, s, frames / s);
+
+    if (out_dir) {
+        if (munmap(map, map_len) != 0 ||
+            write_column(out_dir, "t_us", "<i8", col_t_us, sizeof(*col_t_us)) != 0 ||
+            write_column(out_dir, "seq", "<u4", col_seq, sizeof(*col_seq)) != 0 ||
+            write_column(out_dir, "ta", "<f4", col_ta, sizeof(*col_ta)) != 0 ||
+            write_column(out_dir, "vdd", "<f4", col_vdd, sizeof(*col_vdd)) != 0) {
+            return 1;
+        }
+    }
+    mlx_rec_close(&rec);
+    return 0;
+}
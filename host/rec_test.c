@@ -0,0 +1,197 @@
+/*
+ * 录制格式自检的 C 端（由 main/mlx_rec_test.py 调用，也可单独运行）
+ *
+ *   ./rec_test write 文件 记录数 [contents] [索引容量]
+ *   ./rec_test check 文件 记录数 [truncated]
+ *
+ *   write   用 mlx_rec.c 写一个合成录制（内容由记录下标决定，见 gen），
+ *           contents 默认 3（RAW | CENTI），索引容量默认 16（便于触发隔项丢弃）
+ *   check   用 mlx_rec_map 打开并逐条比对：记录数、每个字段、t_us 对齐、
+ *           索引项间隔、mlx_rec_seek 与逐条查找一致。
+ *           带 truncated 时要求文件没有尾部，记录数按文件长度推算
+ *
+ * mlx_rec_test.py 的 gen() 与这里一一对应，两边写的文件互相检查。
+ *
+ * 构建（在仓库根目录）：
+ *   gcc -O2 -Imain -Ihost main/MLX90640_API.c main/mlx_frame.c main/mlx_proto.c \
+ *       main/mlx_rec.c host/mlx90640_host.c host/mlx_rec_map.c host/rec_test.c -lm -o rec_test
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mlx_rec.h"
+#include "mlx_rec_map.h"
+
+static int failures;
+
+#define CHECK(cond, ...) do {                               \
+        if (!(cond)) {                                      \
+            if (failures++ < 10) {                          \
+                fprintf(stderr, "FAIL: " __VA_ARGS__);      \
+                fputc('\n', stderr);                        \
+            }                                               \
+        }                                                   \
+    } while (0)
+
+/* ================= 合成数据 ================= */
+static int64_t gen_t_us(uint64_t i)
+{
+    return 1000 + (int64_t)i * 62500 + (int64_t)(i % 7) * 13;
+}
+
+static int16_t gen_ta(uint64_t i)
+{
+    return (int16_t)((int64_t)(i % 3000) - 1000);
+}
+
+static uint16_t gen_raw(uint64_t i, int k)
+{
+    return k == 833 ? (uint16_t)(i & 1) : (uint16_t)((i * 31 + (uint64_t)k * 7) & 0xFFFF);
+}
+
+static int16_t gen_centi(uint64_t i, int k)
+{
+    return (int16_t)((int64_t)((i * 17 + (uint64_t)k * 3) % 20000) - 5000);
+}
+
+static void gen(uint64_t i, mlx_raw_frame_t *rf, mlx_frame_t *f)
+{
+    rf->seq = (uint32_t)i;
+    rf->t_us = gen_t_us(i);
+    for (int k = 0; k < MLX_RAW_WORDS; k++) {
+        rf->words[k] = gen_raw(i, k);
+    }
+    memset(f, 0, sizeof(*f));
+    f->seq = (uint32_t)i;
+    f->subpage = (uint8_t)(i & 1);
+    f->t_last_us = gen_t_us(i);
+    f->ta = gen_ta(i) / 100.0f;
+    for (int k = 0; k < MLX90640_PIXEL_NUM; k++) {
+        f->to[k] = gen_centi(i, k) / 100.0f;
+    }
+}
+
+/* ================= write ================= */
+static size_t write_file(const void *data, size_t len, void *ctx)
+{
+    return fwrite(data, 1, len, (FILE *)ctx);
+}
+
+static int cmd_write(const char *path, uint64_t n, uint16_t contents, uint32_t cap)
+{
+    static mlx_raw_frame_t rf;
+    static mlx_frame_t f;
+    static uint16_t ee[MLX90640_EEPROM_DUMP_NUM];
+    mlx_rec_index_t *index = calloc(cap ? cap : 1, sizeof(*index));
+    mlx_rec_writer_t w;
+    mlx_rec_config_t cfg = {
+        .contents = contents, .refresh_rate = 4, .resolution = 3, .pattern = 1,
+        .emissivity = 0.95f, .ta_shift = 8.0f,
+    };
+
+    for (int k = 0; k < MLX90640_EEPROM_DUMP_NUM; k++) {
+        ee[k] = (uint16_t)(k * 3 + 1);
+    }
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL || index == NULL) {
+        perror(path);
+        return 1;
+    }
+    mlx_rec_begin(&w, &cfg, ee, index, cap, write_file, fp);
+    for (uint64_t i = 0; i < n; i++) {
+        gen(i, &rf, &f);
+        mlx_rec_put(&w, &rf, &f);
+    }
+    int ret = mlx_rec_end(&w);
+    fclose(fp);
+    free(index);
+    return ret == 0 ? 0 : 1;
+}
+
+/* ================= check ================= */
+static uint64_t seek_linear(const mlx_rec_map_t *m, int64_t t)
+{
+    uint64_t i = 0;
+    while (i < m->records && mlx_rec_record(m, i)->t_us < t) {
+        i++;
+    }
+    return i;
+}
+
+static int cmd_check(const char *path, uint64_t n, int truncated)
+{
+    mlx_rec_map_t m;
+
+    if (mlx_rec_open(path, &m) != 0) {
+        fprintf(stderr, "FAIL: %s: not a recording\n", path);
+        return 1;
+    }
+    uint16_t contents = m.hdr->contents;
+
+    CHECK(m.records == n, "records %llu, expected %llu", (unsigned long long)m.records,
+          (unsigned long long)n);
+    CHECK(m.truncated == truncated, "truncated %d, expected %d", m.truncated, truncated);
+    CHECK(m.hdr->record_size % MLX_REC_ALIGN == 0, "record_size %u not aligned", m.hdr->record_size);
+    CHECK(m.ee != NULL && m.ee[1] == 4, "EEPROM image");
+    if (failures) {
+        mlx_rec_close(&m);
+        return 1;
+    }
+
+    for (uint64_t i = 0; i < m.records; i++) {
+        const mlx_rec_record_t *r = mlx_rec_record(&m, i);
+        CHECK(((uintptr_t)&r->t_us & 7) == 0, "record %llu: t_us misaligned", (unsigned long long)i);
+        CHECK(r->seq == (uint32_t)i && r->subpage == (i & 1) && r->t_us == gen_t_us(i),
+              "record %llu: head", (unsigned long long)i);
+        if (contents & MLX_REC_CENTI) {
+            CHECK(r->ta == gen_ta(i), "record %llu: ta %d", (unsigned long long)i, r->ta);
+        }
+        const uint16_t *raw = mlx_rec_raw(&m, i);
+        for (int k = 0; raw && k < MLX_RAW_WORDS; k++) {
+            CHECK(raw[k] == gen_raw(i, k), "record %llu: raw[%d]", (unsigned long long)i, k);
+        }
+        const int16_t *centi = mlx_rec_centi(&m, i);
+        for (int k = 0; centi && k < MLX90640_PIXEL_NUM; k++) {
+            CHECK(centi[k] == gen_centi(i, k), "record %llu: to[%d]", (unsigned long long)i, k);
+        }
+    }
+
+    /* 索引项必须落在 stride 的整数倍上，时间与记录一致 */
+    for (uint32_t e = 0; m.index && e < m.entries; e++) {
+        CHECK(m.index[e].record == (uint64_t)e * m.stride &&
+              m.index[e].t_us == gen_t_us(m.index[e].record), "index %u", e);
+    }
+
+    /* seek：每条记录的时间点及其前后 1us，外加两端之外 */
+    for (uint64_t i = 0; i <= m.records; i++) {
+        int64_t base = i < m.records ? gen_t_us(i) : gen_t_us(m.records) + 1;
+        for (int d = -1; d <= 1; d++) {
+            uint64_t a = mlx_rec_seek(&m, base + d), b = seek_linear(&m, base + d);
+            CHECK(a == b, "seek(%lld) = %llu, expected %llu", (long long)(base + d),
+                  (unsigned long long)a, (unsigned long long)b);
+        }
+    }
+    CHECK(mlx_rec_seek(&m, INT64_MIN) == 0, "seek(min)");
+
+    printf("%s: %llu records, %s, index %u x stride %u: %s\n", path, (unsigned long long)m.records,
+           m.truncated ? "truncated" : "footer ok", m.entries, m.stride, failures ? "FAIL" : "ok");
+    mlx_rec_close(&m);
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 4 && strcmp(argv[1], "write") == 0) {
+        return cmd_write(argv[2], strtoull(argv[3], NULL, 0),
+                         argc > 4 ? (uint16_t)strtoul(argv[4], NULL, 0) : MLX_REC_RAW | MLX_REC_CENTI,
+                         argc > 5 ? (uint32_t)strtoul(argv[5], NULL, 0) : 16);
+    }
+    if (argc >= 4 && strcmp(argv[1], "check") == 0) {
+        return cmd_check(argv[2], strtoull(argv[3], NULL, 0),
+                         argc > 4 && strcmp(argv[4], "truncated") == 0);
+    }
+    fprintf(stderr, "usage: %s write FILE N [contents] [index_cap]\n"
+            "       %s check FILE N [truncated]\n", argv[0], argv[0]);
+    return 2;
+}
@@ -0,0 +1,121 @@
+/*
+ * 回放 I2C 录制日志并跑完整的标定流程
+ *
+ *   ./replay_bench 日志 [-r 刷新率代码] [-t] [-o 原始帧输出]
+ *
+ *   -r  与录制端 SetRefreshRate 的参数一致（sim_bench 默认 7，main.c 为 4）
+ *   -t  按日志中的时间间隔实时回放
+ *   -o  将回放得到的 834 字原始帧依次写入文件，可与现场/sim_bench -o 的输出比对
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "MLX90640_I2C_Driver.h"
+#include "MLX90640_API.h"
+#include "mlx90640_replay.h"
+
+#define MLX90640_ADDR   0x33
+#define TA_SHIFT        8
+#define EMISSIVITY      0.95f
+
+static paramsMLX90640 mlx90640;
+static float mlx90640To[MLX90640_PIXEL_NUM];
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+int main(int argc, char **argv)
+{
+    int refresh = 7;
+    int realtime = 0;
+    const char *frames_path = NULL;
+    FILE *frames_out = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:to:")) != -1) {
+        switch (opt) {
+        case 'r': refresh = atoi(optarg) & 0x7; break;
+        case 't': realtime = 1; break;
+        case 'o': frames_path = optarg; break;
+        default:
+            optind = argc;
+            break;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s log [-r refresh] [-t] [-o frames]\n", argv[0]);
+        return 2;
+    }
+
+    if (MLX90640_ReplayOpen(argv[optind], realtime) != 0 || MLX90640_I2CInit() != 0) {
+        fprintf(stderr, "%s: not a capture log\n", argv[optind]);
+        return 1;
+    }
+    if (frames_path && (frames_out = fopen(frames_path, "wb")) == NULL) {
+        perror(frames_path);
+        return 1;
+    }
+
+    static uint16_t eeData[MLX90640_EEPROM_DUMP_NUM];
+    int ret = MLX90640_DumpEE(MLX90640_ADDR, eeData);
+    if (ret == 0) {
+        ret = MLX90640_ExtractParameters(eeData, &mlx90640);
+    }
+    if (ret != 0) {
+        fprintf(stderr, "EEPROM/parameters failed: %d\n", ret);
+        return 1;
+    }
+
+    MLX90640_SetRefreshRate(MLX90640_ADDR, (uint8_t)refresh);
+
+    int frames = 0, errors = 0;
+    double calc_us = 0;
+    double t_start = now_us();
+
+    while (!MLX90640_ReplayAtEnd()) {
+        uint16_t frame[834];
+
+        ret = MLX90640_GetFrameData(MLX90640_ADDR, frame);
+        if (ret < 0) {
+            if (!MLX90640_ReplayAtEnd()) {
+                errors++;
+            }
+            continue;
+        }
+        if (frames_out) {
+            fwrite(frame, sizeof(frame), 1, frames_out);
+        }
+
+        double t0 = now_us();
+        float Ta = MLX90640_GetTa(frame, &mlx90640);
+        MLX90640_CalculateTo(frame, &mlx90640, EMISSIVITY, Ta - TA_SHIFT, mlx90640To);
+        calc_us += now_us() - t0;
+        frames++;
+    }
+
+    double wall = now_us() - t_start;
+    if (frames_out) {
+        fclose(frames_out);
+    }
+
+    mlx90640_replay_stats_t st;
+    MLX90640_ReplayGetStats(&st);
+
+    printf("subpages        %d (errors %d)\n", frames, errors);
+    printf("log time        %.3f s, %u records\n", st.log_us / 1e6, st.records);
+    printf("desync          %u (skipped %u records, %u write diffs)\n",
+           st.desync, st.skipped, st.write_diff);
+    printf("host wall       %.1f ms -> %.0f subpages/s\n", wall / 1e3, frames / (wall / 1e6));
+    if (frames > 0) {
+        printf("CalculateTo     avg %.1f us\n", calc_us / frames);
+    }
+
+    MLX90640_ReplayClose();
+    return (errors || st.desync) ? 1 : 0;
+}
@@ -0,0 +1,227 @@
+/*
+ * 在仿真器上跑 main.c 同样的采集 + 标定流程并计时
+ *
+ *   ./sim_bench [-n 子页数] [-r 刷新率代码 0..7] [-s SCL Hz] [-t]
+ *               [-c 录制日志] [-o 原始帧输出]
+ *
+ *   -t  使用实时时钟（默认虚拟时钟，尽可能快地跑完）
+ *   -c  录制全部 I2C 事务，需以 -DMLX90640_I2C_CAPTURE=1 并链接
+ *       main/MLX90640_I2C_Capture.c 构建，日志可用 replay_bench 回放
+ *   -o  将 GetFrameData 得到的 834 字原始帧依次写入文件
+ *
+ * 以 -DMLX_PROFILE=1 并链接 main/mlx_profile.c 构建时，结束后额外输出
+ * GetFrameData 内部各阶段（wait/pixel/aux）的 min/mean/p50/p99/max。
+ *
+ * 调用顺序与 main.c 一致（DumpEE → SetRefreshRate → GetFrameData 循环），
+ * 录下的日志可以被 replay_bench 逐字节复现。
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "MLX90640_I2C_Driver.h"
+#include "MLX90640_API.h"
+#include "MLX90640_I2C_Capture.h"
+#include "mlx90640_sim.h"
+#include "mlx_profile.h"
+
+#define MLX90640_ADDR   0x33
+#define TA_SHIFT        8
+#define EMISSIVITY      0.95f
+
+typedef struct {
+    double sum;
+    double max;
+} stage_t;
+
+static paramsMLX90640 mlx90640;
+static float mlx90640To[MLX90640_PIXEL_NUM];
+static float truth[MLX90640_PIXEL_NUM];
+
+#if MLX90640_I2C_CAPTURE
+static FILE *capture_out;
+
+static void capture_to_file(const void *buf, size_t len, void *ctx)
+{
+    fwrite(buf, 1, len, (FILE *)ctx);
+}
+#endif
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void stage_add(stage_t *s, double us)
+{
+    s->sum += us;
+    if (us > s->max) {
+        s->max = us;
+    }
+}
+
+static int is_bad_pixel(int p)
+{
+    for (int i = 0; i < 5; i++) {
+        if (mlx90640.brokenPixels[i] == p || mlx90640.outlierPixels[i] == p) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int frames = 640;
+    int refresh = 7;
+    int opt;
+    const char *capture_path = NULL;
+    const char *frames_path = NULL;
+    FILE *frames_out = NULL;
+
+    mlx90640_sim_config_t cfg;
+    MLX90640_SimDefaultConfig(&cfg);
+
+    while ((opt = getopt(argc, argv, "n:r:s:tc:o:")) != -1) {
+        switch (opt) {
+        case 'n': frames = atoi(optarg); break;
+        case 'r': refresh = atoi(optarg) & 0x7; break;
+        case 's': cfg.scl_hz = (uint32_t)atoi(optarg); break;
+        case 't': cfg.realtime = 1; break;
+        case 'c': capture_path = optarg; break;
+        case 'o': frames_path = optarg; break;
+        default:
+            fprintf(stderr, "usage: %s [-n subpages] [-r refresh 0..7] [-s scl_hz] [-t] "
+                    "[-c capture] [-o frames]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (MLX90640_SimInit(&cfg) != 0 || MLX90640_I2CInit() != 0) {
+        fprintf(stderr, "simulator init failed\n");
+        return 1;
+    }
+
+    if (capture_path) {
+#if MLX90640_I2C_CAPTURE
+        if ((capture_out = fopen(capture_path, "wb")) == NULL) {
+            perror(capture_path);
+            return 1;
+        }
+        MLX90640_I2CCaptureStart(capture_to_file, capture_out);
+#else
+        fprintf(stderr, "built without MLX90640_I2C_CAPTURE\n");
+        return 2;
+#endif
+    }
+    if (frames_path && (frames_out = fopen(frames_path, "wb")) == NULL) {
+        perror(frames_path);
+        return 1;
+    }
+
+    static uint16_t eeData[MLX90640_EEPROM_DUMP_NUM];
+    int ret = MLX90640_DumpEE(MLX90640_ADDR, eeData);
+    if (ret == 0) {
+        ret = MLX90640_ExtractParameters(eeData, &mlx90640);
+    }
+    if (ret != 0) {
+        fprintf(stderr, "EEPROM/parameters failed: %d\n", ret);
+        return 1;
+    }
+
+    MLX90640_SetRefreshRate(MLX90640_ADDR, (uint8_t)refresh);
+
+    stage_t st_frame = {0}, st_calc = {0}, st_bad = {0};
+    double err_max = 0, err_sum = 0;
+    long err_n = 0;
+    int errors = 0;
+
+    mlx90640_sim_stats_t s0;
+    MLX90640_SimGetStats(&s0);
+    double t_start = now_us();
+
+    for (int i = 0; i < frames; i++) {
+        uint16_t frame[834];
+
+        double t0 = now_us();
+        ret = MLX90640_GetFrameData(MLX90640_ADDR, frame);
+        double t1 = now_us();
+        if (ret < 0) {
+            errors++;
+            continue;
+        }
+        MLX90640_SimGetTruth(truth);
+        if (frames_out) {
+            fwrite(frame, sizeof(frame), 1, frames_out);
+        }
+
+        float Ta = MLX90640_GetTa(frame, &mlx90640);
+        MLX90640_CalculateTo(frame, &mlx90640, EMISSIVITY, Ta - TA_SHIFT, mlx90640To);
+        double t2 = now_us();
+
+        int mode = (frame[832] & MLX90640_CTRL_MEAS_MODE_MASK) >> MLX90640_CTRL_MEAS_MODE_SHIFT;
+        MLX90640_BadPixelsCorrection(mlx90640.brokenPixels, mlx90640To, mode, &mlx90640);
+        MLX90640_BadPixelsCorrection(mlx90640.outlierPixels, mlx90640To, mode, &mlx90640);
+        double t3 = now_us();
+
+        stage_add(&st_frame, t1 - t0);
+        stage_add(&st_calc, t2 - t1);
+        stage_add(&st_bad, t3 - t2);
+
+        /* 只比较本子页刚更新的像素 */
+        for (int p = 0; p < MLX90640_PIXEL_NUM; p++) {
+            int il = p / 32 - (p / 64) * 2;
+            int pattern = mode ? (il ^ (p & 1)) : il;
+            if (pattern != frame[833] || is_bad_pixel(p)) {
+                continue;
+            }
+            double e = fabs(mlx90640To[p] - truth[p]);
+            err_sum += e;
+            err_n++;
+            if (e > err_max) {
+                err_max = e;
+            }
+        }
+    }
+
+    double wall = now_us() - t_start;
+
+    if (frames_out) {
+        fclose(frames_out);
+    }
+#if MLX90640_I2C_CAPTURE
+    if (capture_out) {
+        MLX90640_I2CCaptureStop();
+        fclose(capture_out);
+    }
+#endif
+    mlx90640_sim_stats_t s1;
+    MLX90640_SimGetStats(&s1);
+
+    int ok = frames - errors;
+    double sim_s = (double)(s1.now_us - s0.now_us) / 1e6;
+
+    printf("subpages        %d (errors %d)\n", frames, errors);
+    printf("sim time        %.3f s  -> %.1f subpages/s (refresh code %d)\n",
+           sim_s, ok / sim_s, refresh);
+    printf("sim bus         %u reads, %u writes, %llu bytes, %u overruns\n",
+           s1.reads - s0.reads, s1.writes - s0.writes,
+           (unsigned long long)(s1.bytes - s0.bytes), s1.overruns - s0.overruns);
+    printf("host wall       %.1f ms\n", wall / 1e3);
+    if (ok > 0) {
+        printf("GetFrameData    avg %8.1f us  max %8.1f us\n", st_frame.sum / ok, st_frame.max);
+        printf("CalculateTo     avg %8.1f us  max %8.1f us\n", st_calc.sum / ok, st_calc.max);
+        printf("BadPixels       avg %8.1f us  max %8.1f us\n", st_bad.sum / ok, st_bad.max);
+    }
+    mlx_profile_dump();
+    if (err_n > 0) {
+        printf("To error        mean %.3f C  max %.3f C\n", err_sum / err_n, err_max);
+    }
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,157 @@
+/*
+ * 在仿真器上验证 step 模式低功耗采集（main.c 的 ACQ_MODE_LOWPOWER）
+ *
+ *   ./step_bench [-n 采集次数] [-r 刷新率代码 0..7] [-p 采集间隔 ms]
+ *                [-a 唤醒电流 mA] [-l 睡眠电流 mA] [-t] [-g]
+ *
+ *   -t  使用实时时钟（默认虚拟时钟，睡眠只推进仿真时间）
+ *   -g  仿真器忽略 general call：每次采集都应返回触发错误，不能卡在状态轮询里
+ *
+ * 检查项：每次触发恰好产生一次转换、自由运行时钟停止（无多余转换 / 覆盖）、
+ * 整帧温度与仿真真值一致，并输出每次采集的唤醒时间、占空比和估算平均电流。
+ *
+ * 构建（在仓库根目录）：
+ *   gcc -O2 -Imain -Ihost main/MLX90640_API.c main/mlx_frame.c main/mlx_step.c \
+ *       host/mlx90640_sim.c host/step_bench.c -lm -o step_bench
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "MLX90640_I2C_Driver.h"
+#include "MLX90640_API.h"
+#include "mlx_frame.h"
+#include "mlx_step.h"
+#include "mlx90640_sim.h"
+
+#define MLX90640_ADDR   0x33
+#define TA_SHIFT        8
+#define EMISSIVITY      0.95f
+
+static paramsMLX90640 mlx90640;
+static mlx_frame_assembler_t assembler;
+static mlx_frame_t frame;
+static uint16_t frameData[834];
+static float truth[MLX90640_PIXEL_NUM];
+
+static int64_t sim_now(void *ctx)
+{
+    return (int64_t)MLX90640_SimNow();
+}
+
+static void sim_sleep(int64_t us, void *ctx)
+{
+    MLX90640_SimSleep((uint64_t)us);
+}
+
+int main(int argc, char **argv)
+{
+    int captures = 20;
+    int refresh = 5;
+    int period_ms = 1000;
+    float active_ma = 40.0f;
+    float sleep_ma = 0.25f;
+    int opt;
+
+    mlx90640_sim_config_t cfg;
+    MLX90640_SimDefaultConfig(&cfg);
+
+    while ((opt = getopt(argc, argv, "n:r:p:a:l:tg")) != -1) {
+        switch (opt) {
+        case 'n': captures = atoi(optarg); break;
+        case 'r': refresh = atoi(optarg) & 0x7; break;
+        case 'p': period_ms = atoi(optarg); break;
+        case 'a': active_ma = (float)atof(optarg); break;
+        case 'l': sleep_ma = (float)atof(optarg); break;
+        case 't': cfg.realtime = 1; break;
+        case 'g': cfg.drop_general_call = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-n captures] [-r refresh 0..7] [-p period_ms] "
+                    "[-a active_ma] [-l sleep_ma] [-t] [-g]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (MLX90640_SimInit(&cfg) != 0 || MLX90640_I2CInit() != 0) {
+        fprintf(stderr, "simulator init failed\n");
+        return 1;
+    }
+
+    static uint16_t eeData[MLX90640_EEPROM_DUMP_NUM];
+    if (MLX90640_DumpEE(MLX90640_ADDR, eeData) != 0 ||
+        MLX90640_ExtractParameters(eeData, &mlx90640) != 0) {
+        fprintf(stderr, "EEPROM/parameters failed\n");
+        return 1;
+    }
+    mlx_frame_assembler_init(&assembler, &mlx90640, EMISSIVITY, TA_SHIFT);
+    MLX90640_SetRefreshRate(MLX90640_ADDR, (uint8_t)refresh);
+
+    mlx_step_t step;
+    mlx_step_init(&step, MLX90640_ADDR, sim_now, sim_sleep, NULL);
+    if (mlx_step_enable(&step, true) != 0) {
+        fprintf(stderr, "step mode enable failed\n");
+        return 1;
+    }
+
+    mlx90640_sim_stats_t s0;
+    MLX90640_SimGetStats(&s0);
+    mlx_step_report_t rep;
+    mlx_step_report(&step, active_ma, sleep_ma, &rep);      // 清掉初始化阶段
+
+    int64_t next = sim_now(NULL);
+    double err_max = 0;
+    int errors = 0;
+
+    for (int i = 0; i < captures; i++) {
+        int64_t t0 = sim_now(NULL);
+        if (mlx_step_capture(&step, &assembler, frameData, &frame) != 0) {
+            errors++;
+        } else {
+            /* 场景在移动，只比较最后一个子页刚更新的像素；跳过坏点 */
+            MLX90640_SimGetTruth(truth);
+            int mode = (frameData[832] & MLX90640_CTRL_MEAS_MODE_MASK) >> MLX90640_CTRL_MEAS_MODE_SHIFT;
+            for (int p = 0; p < MLX90640_PIXEL_NUM; p++) {
+                int il = p / 32 - (p / 64) * 2;
+                int pattern = mode ? (il ^ (p & 1)) : il;
+                if (pattern != frameData[833] || p == mlx90640.outlierPixels[0]) {
+                    continue;
+                }
+                double e = fabs(frame.to[p] - truth[p]);
+                if (e > err_max) {
+                    err_max = e;
+                }
+            }
+        }
+        if (i < 3) {
+            printf("capture %d: %.1f ms (t_first->t_last %.1f ms)\n", i,
+                   (sim_now(NULL) - t0) / 1e3, (frame.t_last_us - frame.t_first_us) / 1e3);
+        }
+
+        next += (int64_t)period_ms * 1000;
+        mlx_step_sleep_until(&step, next);
+    }
+
+    mlx_step_report(&step, active_ma, sleep_ma, &rep);
+    mlx90640_sim_stats_t s1;
+    MLX90640_SimGetStats(&s1);
+
+    uint32_t triggers = s1.triggers - s0.triggers;
+    uint32_t conversions = s1.conversions - s0.conversions;
+
+    printf("captures        %u (errors %d)\n", rep.captures, errors);
+    printf("sensor          %u triggers, %u conversions, %u overruns\n",
+           triggers, conversions, s1.overruns - s0.overruns);
+    printf("ready wait      %.1f status polls per trigger, %u timeouts\n", rep.polls, rep.timeouts);
+    printf("per capture     awake %.2f ms, period %.1f ms, duty %.2f%%\n",
+           rep.awake_ms, rep.period_ms, rep.duty * 100);
+    printf("avg current     %.3f mA (active %.1f mA, light sleep %.2f mA)\n",
+           rep.avg_ma, active_ma, sleep_ma);
+    printf("To error        max %.3f C\n", err_max);
+
+    int ok = cfg.drop_general_call
+             ? errors == captures && conversions == 0
+             : errors == 0 && rep.timeouts == 0 && conversions == triggers && triggers == 2u * captures;
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -16,6 +16,7 @@
  */
 #include <MLX90640_I2C_Driver.h>
 #include <MLX90640_API.h>
+#include "mlx_profile.h"
 #include <math.h>
 
 static void ExtractVDDParameters(uint16_t *eeData, paramsMLX90640 *mlx90640);
@@ -117,8 +118,7 @@ int MLX90640_GetFrameData(uint8_t slaveAddr, uint16_t *frameData)
     uint16_t controlRegister1;
     uint16_t statusRegister;
     int error = 1;
-    uint16_t data[64];
-    uint8_t cnt = 0;
+    int64_t tp = mlx_profile_now();
     
     while(dataReady == 0)
     {
@@ -130,6 +130,7 @@ int MLX90640_GetFrameData(uint8_t slaveAddr, uint16_t *frameData)
         //dataReady = statusRegister & 0x0008;
         dataReady = MLX90640_GET_DATA_READY(statusRegister); 
     }      
+    mlx_profile_record(MLX_PROF_WAIT, mlx_profile_now() - tp);
     
     error = MLX90640_I2CWrite(slaveAddr, MLX90640_STATUS_REG, MLX90640_INIT_STATUS_VALUE);
     if(error == -MLX90640_I2C_NACK_ERROR)
@@ -137,13 +138,18 @@ int MLX90640_GetFrameData(uint8_t slaveAddr, uint16_t *frameData)
         return error;
     }
                      
+    tp = mlx_profile_now();
     error = MLX90640_I2CRead(slaveAddr, MLX90640_PIXEL_DATA_START_ADDRESS, MLX90640_PIXEL_NUM, frameData); 
     if(error != MLX90640_NO_ERROR)
     {
         return error;
     }                       
+    mlx_profile_record(MLX_PROF_PIXEL, mlx_profile_now() - tp);
     
-    error = MLX90640_I2CRead(slaveAddr, MLX90640_AUX_DATA_START_ADDRESS, MLX90640_AUX_NUM, data); 
+    tp = mlx_profile_now();
+    
+    /* aux 数据直接读入 frameData[768..831]，不经过中间缓冲 */
+    error = MLX90640_I2CRead(slaveAddr, MLX90640_AUX_DATA_START_ADDRESS, MLX90640_AUX_NUM, &frameData[MLX90640_PIXEL_NUM]); 
     if(error != MLX90640_NO_ERROR)
     {
         return error;
@@ -158,14 +164,12 @@ int MLX90640_GetFrameData(uint8_t slaveAddr, uint16_t *frameData)
     {
         return error;
     }
+    mlx_profile_record(MLX_PROF_AUX, mlx_profile_now() - tp);
     
-    error = ValidateAuxData(data);
-    if(error == MLX90640_NO_ERROR)
+    error = ValidateAuxData(&frameData[MLX90640_PIXEL_NUM]);
+    if(error != MLX90640_NO_ERROR)
     {
-        for(cnt=0; cnt<MLX90640_AUX_NUM; cnt++)
-        {
-            frameData[cnt+MLX90640_PIXEL_NUM] = data[cnt];
-        }
+        return error;
     }        
     
     error = ValidateFrameData(frameData);
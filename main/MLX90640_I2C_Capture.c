@@ -0,0 +1,136 @@
+#include "MLX90640_I2C_Capture.h"
+
+#include <string.h>
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    put16(p, (uint16_t)v);
+    put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+/* ================= 编解码 ================= */
+size_t MLX90640_CaptureEncodeFileHeader(uint8_t *out)
+{
+    memcpy(out, MLX90640_CAPTURE_MAGIC, 4);
+    put16(out + 4, MLX90640_CAPTURE_VERSION);
+    put16(out + 6, 0);
+    return MLX90640_CAPTURE_FILE_HDR;
+}
+
+int MLX90640_CaptureDecodeFileHeader(const uint8_t *in)
+{
+    if (memcmp(in, MLX90640_CAPTURE_MAGIC, 4) != 0) {
+        return -1;
+    }
+    return (get16(in + 4) == MLX90640_CAPTURE_VERSION) ? 0 : -1;
+}
+
+size_t MLX90640_CaptureEncodeRecord(uint8_t *out, const mlx90640_capture_rec_t *rec)
+{
+    out[0] = rec->type;
+    out[1] = (uint8_t)rec->result;
+    put16(out + 2, rec->reg);
+    put16(out + 4, rec->nWords);
+    put32(out + 6, rec->dt_us);
+    return MLX90640_CAPTURE_REC_HDR;
+}
+
+void MLX90640_CaptureDecodeRecord(const uint8_t *in, mlx90640_capture_rec_t *rec)
+{
+    rec->type   = in[0];
+    rec->result = (int8_t)in[1];
+    rec->reg    = get16(in + 2);
+    rec->nWords = get16(in + 4);
+    rec->dt_us  = get32(in + 6);
+}
+
+/* ================= 录制 ================= */
+#if MLX90640_I2C_CAPTURE
+
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#define capture_now_us()    ((uint64_t)esp_timer_get_time())
+#else
+#include <time.h>
+static uint64_t capture_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+#endif
+
+static mlx90640_capture_sink_t capture_sink;
+static void *capture_ctx;
+static uint64_t capture_last_us;
+
+/* 最大负载为一次 EEPROM 整读 */
+static uint8_t capture_buf[MLX90640_CAPTURE_REC_HDR + 2 * 832];
+
+void MLX90640_I2CCaptureStart(mlx90640_capture_sink_t sink, void *ctx)
+{
+    capture_ctx = ctx;
+    capture_last_us = capture_now_us();
+
+    size_t n = MLX90640_CaptureEncodeFileHeader(capture_buf);
+    sink(capture_buf, n, ctx);
+    capture_sink = sink;
+}
+
+void MLX90640_I2CCaptureStop(void)
+{
+    capture_sink = NULL;
+}
+
+void MLX90640_I2CCaptureRecord(uint8_t type, uint16_t reg, uint16_t nWords,
+                               const uint16_t *data, int result)
+{
+    if (capture_sink == NULL) {
+        return;
+    }
+
+    uint64_t now = capture_now_us();
+    mlx90640_capture_rec_t rec = {
+        .type   = type,
+        .result = (int8_t)result,
+        .reg    = reg,
+        .nWords = nWords,
+        .dt_us  = (uint32_t)(now - capture_last_us),
+    };
+    capture_last_us = now;
+
+    size_t n = MLX90640_CaptureEncodeRecord(capture_buf, &rec);
+
+    size_t payload = 0;
+    if (type == MLX90640_CAPTURE_WRITE) {
+        payload = 1;
+    } else if (type == MLX90640_CAPTURE_READ && result == 0) {
+        payload = nWords;
+    }
+    if (n + 2 * payload > sizeof(capture_buf)) {
+        payload = 0;
+    }
+    for (size_t i = 0; i < payload; i++) {
+        put16(capture_buf + n + 2 * i, data[i]);
+    }
+
+    capture_sink(capture_buf, n + 2 * payload, capture_ctx);
+}
+
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * I2C 原始事务录制
+ *
+ * 开启 MLX90640_I2C_CAPTURE 后，MLX90640_I2CRead/Write/GeneralReset 的每次事务
+ * 都会编码成一条紧凑的二进制记录交给 sink（串口、文件等）。
+ * 主机端 host/mlx90640_replay.c 按同样的格式回放，GetFrameData 得到的数据
+ * 与现场逐字节一致。
+ *
+ * 固件把日志写到控制台 UART（main.c），sink 在 I2C 事务里同步调用，
+ * 串口带宽不够时写入阻塞，录到的 dt_us 就成了串口的背压而不是总线时序。
+ * 一个子页约 1.7 KB，外加每次状态轮询 12 字节：8Hz 子页已经超过 115200
+ * 的约 11.5 KB/s。所以录制开始时控制台切到 CONFIG_MLX90640_I2C_CAPTURE_BAUD
+ * （默认 921600，约 92 KB/s，够 16Hz 子页），主机按这个波特率保存串口数据；
+ * 前面 115200 的启动日志会乱码，回放时跳过。
+ *
+ * 日志格式（小端）：
+ *   文件头  "MLXC" | u16 版本 | u16 保留
+ *   记录头  u8 类型 | i8 结果 | u16 寄存器 | u16 字数 | u32 距上一条的 us
+ *   负载    读：成功时 nWords 个 u16（已转换为主机字节序）
+ *           写：1 个 u16
+ *           复位：无
+ */
+#ifndef MLX90640_I2C_CAPTURE
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+#ifdef CONFIG_MLX90640_I2C_CAPTURE
+#define MLX90640_I2C_CAPTURE 1
+#else
+#define MLX90640_I2C_CAPTURE 0
+#endif
+#endif
+
+#define MLX90640_CAPTURE_MAGIC      "MLXC"
+#define MLX90640_CAPTURE_VERSION    1
+#define MLX90640_CAPTURE_FILE_HDR   8
+#define MLX90640_CAPTURE_REC_HDR    10
+
+#define MLX90640_CAPTURE_READ       'R'
+#define MLX90640_CAPTURE_WRITE      'W'
+#define MLX90640_CAPTURE_RESET      'G'
+
+typedef struct {
+    uint8_t  type;
+    int8_t   result;
+    uint16_t reg;
+    uint16_t nWords;
+    uint32_t dt_us;
+} mlx90640_capture_rec_t;
+
+typedef void (*mlx90640_capture_sink_t)(const void *buf, size_t len, void *ctx);
+
+/* 编解码，录制和回放共用 */
+size_t MLX90640_CaptureEncodeFileHeader(uint8_t *out);
+int    MLX90640_CaptureDecodeFileHeader(const uint8_t *in);
+size_t MLX90640_CaptureEncodeRecord(uint8_t *out, const mlx90640_capture_rec_t *rec);
+void   MLX90640_CaptureDecodeRecord(const uint8_t *in, mlx90640_capture_rec_t *rec);
+
+#if MLX90640_I2C_CAPTURE
+
+void MLX90640_I2CCaptureStart(mlx90640_capture_sink_t sink, void *ctx);
+void MLX90640_I2CCaptureStop(void);
+void MLX90640_I2CCaptureRecord(uint8_t type, uint16_t reg, uint16_t nWords,
+                               const uint16_t *data, int result);
+
+#define MLX90640_I2C_CAPTURE_RECORD(type, reg, nWords, data, result) \
+    MLX90640_I2CCaptureRecord((type), (reg), (nWords), (data), (result))
+
+#else
+
+#define MLX90640_I2C_CAPTURE_RECORD(type, reg, nWords, data, result) do { } while (0)
+
+#endif
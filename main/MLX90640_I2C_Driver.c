@@ -1,10 +1,18 @@
 #include "MLX90640_I2C_Driver.h"
+#include "MLX90640_I2C_Trace.h"
+#include "MLX90640_I2C_Capture.h"
+
+#include <string.h>
+#include <inttypes.h>
 
 #include "driver/i2c_master.h"
+#include "driver/gpio.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
 
 #define TAG "MLX90640_I2C"
 
@@ -14,29 +22,44 @@
 #define I2C_SCL_GPIO    10
 #define I2C_FREQ_HZ     100000   // EEPROM 阶段稳定优先
 
+#define RECOVER_CLOCKS  9        // 释放被卡住的 SDA 最多需要 9 个 SCL
+#define RECOVER_HALF_US 5
+
+#define GENERAL_CALL_ADDR   0x00
+#define GENERAL_CALL_RESET  0x06
+#define GENERAL_CALL_WAIT_US 50  // 与 Melexis 参考驱动相同，复位后留给器件的时间
+
 static i2c_master_bus_handle_t bus_handle = NULL;
 static i2c_master_dev_handle_t dev_handle = NULL;
+static mlx90640_i2c_recovery_stats_t recovery_stats;
+
+static const i2c_master_bus_config_t bus_cfg = {
+    .i2c_port = I2C_PORT_NUM,
+    .sda_io_num = I2C_SDA_GPIO,
+    .scl_io_num = I2C_SCL_GPIO,
+    .clk_source = I2C_CLK_SRC_DEFAULT,
+    .glitch_ignore_cnt = 7,
+    .flags.enable_internal_pullup = false,
+};
+
+static const i2c_device_config_t dev_cfg = {
+    .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+    .device_address  = 0x33,
+    .scl_speed_hz    = I2C_FREQ_HZ,
+};
+
+/* general call 只在 step 模式触发时用到，临时挂到总线上，发完即移除 */
+static const i2c_device_config_t general_call_cfg = {
+    .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+    .device_address  = GENERAL_CALL_ADDR,
+    .scl_speed_hz    = I2C_FREQ_HZ,
+};
 
 /* ================= 初始化 ================= */
 esp_err_t MLX90640_I2CInit(void)
 {
-    i2c_master_bus_config_t bus_cfg = {
-        .i2c_port = I2C_PORT_NUM,
-        .sda_io_num = I2C_SDA_GPIO,
-        .scl_io_num = I2C_SCL_GPIO,
-        .clk_source = I2C_CLK_SRC_DEFAULT,
-        .glitch_ignore_cnt = 7,
-        .flags.enable_internal_pullup = false,
-    };
-
     ESP_ERROR_CHECK(i2c_new_master_bus(&bus_cfg, &bus_handle));
 
-    i2c_device_config_t dev_cfg = {
-        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-        .device_address  = 0x33,
-        .scl_speed_hz    = I2C_FREQ_HZ,
-    };
-
     ESP_ERROR_CHECK(
         i2c_master_bus_add_device(bus_handle, &dev_cfg, &dev_handle)
     );
@@ -45,6 +68,156 @@ esp_err_t MLX90640_I2CInit(void)
     return ESP_OK;
 }
 
+/* ================= 总线恢复 ================= */
+
+/* 读一次状态寄存器确认器件重新应答 */
+static esp_err_t probe_device(void)
+{
+    uint8_t reg[2] = { 0x80, 0x00 };
+    uint8_t status[2];
+
+    return i2c_master_transmit_receive(dev_handle, reg, 2, status, 2, pdMS_TO_TICKS(20));
+}
+
+/* 释放 I2C 外设后用 GPIO 手动打 SCL，直到从机松开 SDA，再补一个 STOP */
+static esp_err_t bus_clear_gpio(void)
+{
+    gpio_config_t io = {
+        .pin_bit_mask = (1ULL << I2C_SCL_GPIO) | (1ULL << I2C_SDA_GPIO),
+        .mode = GPIO_MODE_INPUT_OUTPUT_OD,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    gpio_config(&io);
+
+    gpio_set_level(I2C_SDA_GPIO, 1);
+    gpio_set_level(I2C_SCL_GPIO, 1);
+    esp_rom_delay_us(RECOVER_HALF_US);
+
+    for (int i = 0; i < RECOVER_CLOCKS && gpio_get_level(I2C_SDA_GPIO) == 0; i++) {
+        gpio_set_level(I2C_SCL_GPIO, 0);
+        esp_rom_delay_us(RECOVER_HALF_US);
+        gpio_set_level(I2C_SCL_GPIO, 1);
+        esp_rom_delay_us(RECOVER_HALF_US);
+    }
+
+    /* STOP：SCL 高时 SDA 由低变高 */
+    gpio_set_level(I2C_SCL_GPIO, 0);
+    gpio_set_level(I2C_SDA_GPIO, 0);
+    esp_rom_delay_us(RECOVER_HALF_US);
+    gpio_set_level(I2C_SCL_GPIO, 1);
+    esp_rom_delay_us(RECOVER_HALF_US);
+    gpio_set_level(I2C_SDA_GPIO, 1);
+    esp_rom_delay_us(RECOVER_HALF_US);
+
+    esp_err_t ret = gpio_get_level(I2C_SDA_GPIO) ? ESP_OK : ESP_FAIL;
+
+    gpio_reset_pin(I2C_SCL_GPIO);
+    gpio_reset_pin(I2C_SDA_GPIO);
+    return ret;
+}
+
+/*
+ * 恢复顺序，每一步成功即返回：
+ *   1. 移除设备 → i2c_master_bus_reset（控制器内部打时钟）→ 重新添加 → 探测
+ *   2. 删除总线 → GPIO 手动打 SCL + STOP → 重建总线 → 重新添加 → 探测
+ * 子页重同步（MLX90640_SynchFrame）由调用方完成。
+ */
+int MLX90640_I2CRecover(void)
+{
+    int64_t t0 = esp_timer_get_time();
+    esp_err_t ret;
+
+    recovery_stats.events++;
+
+    if (dev_handle) {
+        i2c_master_bus_rm_device(dev_handle);
+        dev_handle = NULL;
+    }
+
+    ret = i2c_master_bus_reset(bus_handle);
+    if (ret == ESP_OK) {
+        ret = i2c_master_bus_add_device(bus_handle, &dev_cfg, &dev_handle);
+    }
+    if (ret == ESP_OK) {
+        ret = probe_device();
+    }
+
+    if (ret != ESP_OK) {
+        recovery_stats.bus_clears++;
+
+        if (dev_handle) {
+            i2c_master_bus_rm_device(dev_handle);
+            dev_handle = NULL;
+        }
+        i2c_del_master_bus(bus_handle);
+        bus_handle = NULL;
+
+        if (bus_clear_gpio() != ESP_OK) {
+            ESP_LOGW(TAG, "SDA still held low after bus clear");
+        }
+
+        ret = i2c_new_master_bus(&bus_cfg, &bus_handle);
+        if (ret == ESP_OK) {
+            ret = i2c_master_bus_add_device(bus_handle, &dev_cfg, &dev_handle);
+        }
+        if (ret == ESP_OK) {
+            ret = probe_device();
+        }
+    }
+
+    uint32_t dt = (uint32_t)(esp_timer_get_time() - t0);
+    recovery_stats.last_us = dt;
+    recovery_stats.total_us += dt;
+    if (dt > recovery_stats.max_us) {
+        recovery_stats.max_us = dt;
+    }
+
+    if (ret != ESP_OK) {
+        recovery_stats.failures++;
+        ESP_LOGE(TAG, "I2C recovery failed: %s (%" PRIu32 " us)", esp_err_to_name(ret), dt);
+        return -1;
+    }
+
+    ESP_LOGW(TAG, "I2C recovered in %" PRIu32 " us (events %" PRIu32 ", bus clears %" PRIu32 ")",
+             dt, recovery_stats.events, recovery_stats.bus_clears);
+    return 0;
+}
+
+void MLX90640_I2CGetRecoveryStats(mlx90640_i2c_recovery_stats_t *stats)
+{
+    *stats = recovery_stats;
+}
+
+/* ================= 字节序转换 ================= */
+
+/*
+ * MLX90640 是 big-endian，ESP32-S3 是 little-endian。
+ * 一次处理 32 位（两个字），首尾不对齐的字单独处理。
+ * memcpy 在对齐地址上会被编译成单条 l32i/s32i。
+ */
+static inline void swap_words_be(uint16_t *data, uint16_t nWords)
+{
+    uint16_t i = 0;
+
+    if (nWords > 0 && ((uintptr_t)data & 0x2)) {
+        data[0] = (uint16_t)((data[0] << 8) | (data[0] >> 8));
+        i = 1;
+    }
+
+    for (; i + 1 < nWords; i += 2) {
+        uint32_t v;
+        memcpy(&v, &data[i], sizeof(v));
+        v = ((v & 0x00FF00FFu) << 8) | ((v >> 8) & 0x00FF00FFu);
+        memcpy(&data[i], &v, sizeof(v));
+    }
+
+    if (i < nWords) {
+        data[i] = (uint16_t)((data[i] << 8) | (data[i] >> 8));
+    }
+}
+
 /* ================= MLX90640 API 兼容接口 ================= */
 
 void MLX90640_I2CFreqSet(int freq)
@@ -52,8 +225,30 @@ void MLX90640_I2CFreqSet(int freq)
     (void)freq; // ESP-IDF 5.x 不支持运行时改速
 }
 
+/*
+ * I2C general call reset：地址 0x00 + 数据 0x06。
+ * MLX90640_TriggerMeasurement 写 CTRL bit15 后靠它启动 step 模式的一次转换。
+ */
 int MLX90640_I2CGeneralReset(void)
 {
+    static const uint8_t cmd = GENERAL_CALL_RESET;
+    i2c_master_dev_handle_t gc_handle = NULL;
+
+    MLX90640_I2C_TRACE_BEGIN(t0);
+
+    esp_err_t ret = i2c_master_bus_add_device(bus_handle, &general_call_cfg, &gc_handle);
+    if (ret == ESP_OK) {
+        ret = i2c_master_transmit(gc_handle, &cmd, 1, pdMS_TO_TICKS(200));
+        i2c_master_bus_rm_device(gc_handle);
+    }
+
+    MLX90640_I2C_TRACE_END(t0, MLX90640_I2C_TRACE_RESET_REG, 0, 1, ret == ESP_OK ? 0 : -1);
+    MLX90640_I2C_CAPTURE_RECORD(MLX90640_CAPTURE_RESET, 0, 0, NULL, ret == ESP_OK ? 0 : -1);
+
+    if (ret != ESP_OK) {
+        return -1;
+    }
+    esp_rom_delay_us(GENERAL_CALL_WAIT_US);
     return 0;
 }
 
@@ -67,6 +262,8 @@ int MLX90640_I2CRead(uint8_t slaveAddr,
         startAddress & 0xFF
     };
 
+    MLX90640_I2C_TRACE_BEGIN(t0);
+
     esp_err_t ret = i2c_master_transmit_receive(
         dev_handle,
         reg,
@@ -76,14 +273,17 @@ int MLX90640_I2CRead(uint8_t slaveAddr,
         pdMS_TO_TICKS(200)
     );
 
-    if (ret != ESP_OK)
-        return -1;
+    MLX90640_I2C_TRACE_END(t0, startAddress, nWords, 0, ret == ESP_OK ? 0 : -1);
 
-    /* MLX90640 是 big-endian */
-    for (int i = 0; i < nWords; i++) {
-        data[i] = (data[i] << 8) | (data[i] >> 8);
+    if (ret != ESP_OK) {
+        MLX90640_I2C_CAPTURE_RECORD(MLX90640_CAPTURE_READ, startAddress, nWords, data, -1);
+        return -1;
     }
 
+    swap_words_be(data, nWords);
+
+    MLX90640_I2C_CAPTURE_RECORD(MLX90640_CAPTURE_READ, startAddress, nWords, data, 0);
+
     return 0;
 }
 
@@ -98,6 +298,8 @@ int MLX90640_I2CWrite(uint8_t slaveAddr,
         data & 0xFF
     };
 
+    MLX90640_I2C_TRACE_BEGIN(t0);
+
     esp_err_t ret = i2c_master_transmit(
         dev_handle,
         buf,
@@ -105,5 +307,9 @@ int MLX90640_I2CWrite(uint8_t slaveAddr,
         pdMS_TO_TICKS(200)
     );
 
+    MLX90640_I2C_TRACE_END(t0, writeAddress, 1, 1, ret == ESP_OK ? 0 : -1);
+    MLX90640_I2C_CAPTURE_RECORD(MLX90640_CAPTURE_WRITE, writeAddress, 1, &data,
+                                ret == ESP_OK ? 0 : -1);
+
     return (ret == ESP_OK) ? 0 : -1;
 }
@@ -2,7 +2,18 @@
 
 #include <stdint.h>
 
+typedef struct {
+    uint32_t events;        // 调用 MLX90640_I2CRecover 的次数
+    uint32_t bus_clears;    // 需要 GPIO 手动清总线的次数
+    uint32_t failures;
+    uint32_t last_us;
+    uint32_t max_us;
+    uint64_t total_us;
+} mlx90640_i2c_recovery_stats_t;
+
 int MLX90640_I2CInit(void);
 int MLX90640_I2CRead(uint8_t slaveAddr, uint16_t reg, uint16_t len, uint16_t *data);
 int MLX90640_I2CWrite(uint8_t slaveAddr, uint16_t reg, uint16_t data);
 int MLX90640_I2CGeneralReset(void);
+int MLX90640_I2CRecover(void);
+void MLX90640_I2CGetRecoveryStats(mlx90640_i2c_recovery_stats_t *stats);
@@ -0,0 +1,150 @@
+#include "MLX90640_I2C_Trace.h"
+
+#if MLX90640_I2C_TRACE
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "esp_log.h"
+
+#define TAG "MLX90640_TRACE"
+
+#define TRACE_MASK      (MLX90640_I2C_TRACE_DEPTH - 1)
+#define HIST_BUCKETS    12      // <32us, <64us ... >=32ms
+
+_Static_assert((MLX90640_I2C_TRACE_DEPTH & TRACE_MASK) == 0,
+               "MLX90640_I2C_TRACE_DEPTH must be a power of two");
+
+/* 每次 I2C 事务都写，属于热数据，留在内部 DRAM（见 mlx_placement.h） */
+static mlx90640_i2c_trace_rec_t trace_ring[MLX90640_I2C_TRACE_DEPTH];
+static uint32_t trace_head;
+
+/* ================= 地址分类 ================= */
+typedef enum {
+    RANGE_STATUS = 0,
+    RANGE_PIXEL,
+    RANGE_AUX,
+    RANGE_CTRL,
+    RANGE_EEPROM,
+    RANGE_RESET,
+    RANGE_OTHER,
+    RANGE_NUM
+} trace_range_t;
+
+static const char *const range_names[RANGE_NUM] = {
+    "status", "pixel", "aux", "ctrl", "eeprom", "reset", "other"
+};
+
+static trace_range_t classify(uint16_t reg, uint16_t len)
+{
+    if (reg == MLX90640_I2C_TRACE_RESET_REG && len == 0) return RANGE_RESET;
+    if (reg == 0x8000)                  return RANGE_STATUS;
+    if (reg == 0x800D)                  return RANGE_CTRL;
+    if (reg >= 0x0400 && reg < 0x0700)  return RANGE_PIXEL;
+    if (reg >= 0x0700 && reg < 0x0740)  return RANGE_AUX;
+    if (reg >= 0x2400 && reg < 0x2740)  return RANGE_EEPROM;
+    return RANGE_OTHER;
+}
+
+static int bucket_of(uint32_t us)
+{
+    int b = 0;
+    us >>= 5;
+    while (us && b < HIST_BUCKETS - 1) {
+        us >>= 1;
+        b++;
+    }
+    return b;
+}
+
+/* ================= 记录 ================= */
+void MLX90640_I2CTraceRecord(uint16_t reg, uint16_t len, int write,
+                             int64_t start_us, int result)
+{
+    int64_t now = esp_timer_get_time();
+    uint32_t seq = __atomic_fetch_add(&trace_head, 1, __ATOMIC_RELAXED);
+    mlx90640_i2c_trace_rec_t *r = &trace_ring[seq & TRACE_MASK];
+
+    /* 先作废槽位，写完再发布序号，Dump 据此丢弃写了一半的记录 */
+    __atomic_store_n(&r->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    r->start_us    = (uint32_t)start_us;
+    r->duration_us = (uint32_t)(now - start_us);
+    r->reg         = reg;
+    r->len         = len;
+    r->write       = write ? 1 : 0;
+    r->result      = (int8_t)result;
+    __atomic_store_n(&r->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+void MLX90640_I2CTraceReset(void)
+{
+    for (int i = 0; i < MLX90640_I2C_TRACE_DEPTH; i++) {
+        __atomic_store_n(&trace_ring[i].seq, 0, __ATOMIC_RELAXED);
+    }
+}
+
+/* ================= 输出直方图 ================= */
+void MLX90640_I2CTraceDump(void)
+{
+    struct {
+        uint32_t count;
+        uint32_t errors;
+        uint32_t min_us;
+        uint32_t max_us;
+        uint64_t sum_us;
+        uint32_t hist[HIST_BUCKETS];
+    } st[RANGE_NUM];
+
+    memset(st, 0, sizeof(st));
+    for (int i = 0; i < RANGE_NUM; i++) {
+        st[i].min_us = UINT32_MAX;
+    }
+
+    for (int i = 0; i < MLX90640_I2C_TRACE_DEPTH; i++) {
+        const mlx90640_i2c_trace_rec_t *r = &trace_ring[i];
+        uint32_t seq = __atomic_load_n(&r->seq, __ATOMIC_ACQUIRE);
+        if (seq == 0) {
+            continue;
+        }
+        uint16_t reg   = r->reg;
+        uint16_t len   = r->len;
+        uint32_t dur   = r->duration_us;
+        int8_t  result = r->result;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&r->seq, __ATOMIC_RELAXED) != seq) {
+            continue;   // 读取期间被覆盖
+        }
+
+        trace_range_t k = classify(reg, len);
+        st[k].count++;
+        st[k].errors += (result != 0);
+        st[k].sum_us += dur;
+        if (dur < st[k].min_us) st[k].min_us = dur;
+        if (dur > st[k].max_us) st[k].max_us = dur;
+        st[k].hist[bucket_of(dur)]++;
+    }
+
+    ESP_LOGI(TAG, "I2C trace, last %d transactions (buckets: <32us x2 ... >=32ms)",
+             MLX90640_I2C_TRACE_DEPTH);
+
+    for (int k = 0; k < RANGE_NUM; k++) {
+        if (st[k].count == 0) {
+            continue;
+        }
+
+        char line[160];
+        int len = 0;
+        for (int b = 0; b < HIST_BUCKETS; b++) {
+            len += snprintf(line + len, sizeof(line) - len, "%" PRIu32 " ", st[k].hist[b]);
+        }
+
+        ESP_LOGI(TAG, "%-6s n=%-4" PRIu32 " err=%" PRIu32 " min=%" PRIu32 " avg=%" PRIu32
+                 " max=%" PRIu32 "us | %s",
+                 range_names[k], st[k].count, st[k].errors, st[k].min_us,
+                 (uint32_t)(st[k].sum_us / st[k].count), st[k].max_us, line);
+    }
+}
+
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * I2C 事务追踪
+ *
+ * 在 MLX90640_I2CRead/MLX90640_I2CWrite 内记录每次事务的地址、长度、
+ * 耗时和结果，写入固定大小的无锁环形缓冲。
+ * MLX90640_I2C_TRACE 为 0 时所有接口编译为空，可保留在量产代码中。
+ * 固件用 menuconfig 打开（CONFIG_MLX90640_I2C_TRACE），主机程序用 -D 定义。
+ */
+#ifndef MLX90640_I2C_TRACE
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+#ifdef CONFIG_MLX90640_I2C_TRACE
+#define MLX90640_I2C_TRACE 1
+#else
+#define MLX90640_I2C_TRACE 0
+#endif
+#endif
+
+#define MLX90640_I2C_TRACE_DEPTH 256   // 必须是 2 的幂
+#define MLX90640_I2C_TRACE_RESET_REG 0x0000   // general call reset 记为寄存器 0、长度 0 的写
+
+typedef struct {
+    uint32_t seq;           // 写入序号 + 1，0 表示空槽
+    uint32_t start_us;
+    uint32_t duration_us;
+    uint16_t reg;
+    uint16_t len;           // 字数
+    uint8_t  write;
+    int8_t   result;
+} mlx90640_i2c_trace_rec_t;
+
+#if MLX90640_I2C_TRACE
+
+#include "esp_timer.h"
+
+void MLX90640_I2CTraceRecord(uint16_t reg, uint16_t len, int write,
+                             int64_t start_us, int result);
+void MLX90640_I2CTraceDump(void);
+void MLX90640_I2CTraceReset(void);
+
+#define MLX90640_I2C_TRACE_BEGIN(t0) \
+    int64_t t0 = esp_timer_get_time()
+#define MLX90640_I2C_TRACE_END(t0, reg, len, write, result) \
+    MLX90640_I2CTraceRecord((reg), (len), (write), (t0), (result))
+
+#else
+
+#define MLX90640_I2C_TRACE_BEGIN(t0)
+#define MLX90640_I2C_TRACE_END(t0, reg, len, write, result) do { } while (0)
+
+static inline void MLX90640_I2CTraceDump(void) { }
+static inline void MLX90640_I2CTraceReset(void) { }
+
+#endif
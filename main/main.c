@@ -1,15 +1,39 @@
 #include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
 #include <inttypes.h>
+#include <unistd.h>
+#include <fcntl.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "esp_err.h"
+#include "esp_timer.h"
+#include "esp_sleep.h"
+#include "esp_memory_utils.h"
+#include "driver/uart.h"
+#include "driver/uart_vfs.h"
 
 #include "MLX90640_API.h"
 #include "MLX90640_I2C_Driver.h"
+#include "MLX90640_I2C_Trace.h"
+#include "MLX90640_I2C_Capture.h"
+#include "mlx_frame.h"
+#include "mlx_queue.h"
+#include "mlx_pool.h"
+#include "mlx_profile.h"
+#include "mlx_sched.h"
+#include "mlx_cmd.h"
+#include "mlx_step.h"
+#include "mlx_sysmon.h"
+#include "mlx_proto.h"
+#include "mlx_usbout.h"
+#include "mlx_delta.h"
+#include "mlx_placement.h"
 
 /* ================= 用户配置 ================= */
 #define TAG "MLX90640"
@@ -22,10 +46,110 @@
 #define BOOT_BUTTON_GPIO GPIO_NUM_0  // BOOT 按键
 #define MLX90640_ADDR   0x33
 #define TA_SHIFT        8
+#define EMISSIVITY      0.95f
+
+/* 采集模式 */
+#define ACQ_MODE_BUTTON 0           // 每按一次 BOOT 读一个子页
+#define ACQ_MODE_STREAM 1           // 按刷新率连续采集，BOOT 键暂停/继续
+#define ACQ_MODE_LOWPOWER 2         // step 模式定时采集，其余时间 light sleep
+#define ACQ_MODE        ACQ_MODE_STREAM
+
+#define REFRESH_RATE    0x04        // 0x00=0.5Hz ... 0x07=64Hz（子页速率），0x04 = 8Hz 子页 / 4Hz 整帧
+#define PRINT_EVERY     4           // 连续模式下文本格式每 N 个整帧打印一次（二进制和按键模式每帧都输出）
+#define STATS_PERIOD_US 5000000     // 统计输出周期
+#define WAKE_MARGIN_US  2000        // 比预测的 data-ready 提前醒来开始轮询的余量
+
+/* 低功耗模式（ACQ_MODE_LOWPOWER） */
+#define LP_CAPTURE_PERIOD_US 10000000   // 采集间隔
+#define LP_REPORT_EVERY      6          // 每 N 次采集输出一次功耗估算
+#define LP_ACTIVE_MA         40.0f      // 唤醒时 S3 电流（按板子实测修改）
+#define LP_SLEEP_MA          0.25f      // light sleep 电流
+
+/* 输出格式，可用 MLX_CMD_SET_OUTPUT 运行时切换 */
+#define OUTPUT_TEXT     0           // "Row NN:" 矩阵（mlx90640_viewer.py）
+#define OUTPUT_CSV      1           // FRAME_BEGIN / CSV / FRAME_END（mlx_s3.py）
+#define OUTPUT_OFF      2           // 只输出统计
+#define OUTPUT_BINARY   3           // COBS 二进制帧（mlx_proto.h / mlx_proto.py）
+#define OUTPUT_DELTA    4           // 二进制，关键帧 + 时域差分（mlx_delta.h）
+#define OUTPUT_RAW      5           // 原始子页 + EEPROM 标定包，温度由主机计算（仅连续 / 按键模式）
+#define OUTPUT_FORMATS  6
+#define CALIB_EVERY     256         // raw 输出时每 N 个子页重发一次标定包，供后连上的主机使用
+
+/* 二进制帧走哪个口：控制台（UART，115200 下只够约 7 帧/s）或 S3 内置 USB Serial/JTAG */
+#define OUTPUT_PORT_CONSOLE 0
+#define OUTPUT_PORT_USB     1
+#define OUTPUT_PORT         OUTPUT_PORT_USB
+#define USBOUT_TIMEOUT_MS   0       // 环形缓冲满时的最长等待，0 = 立即丢包
+#define CONSOLE_RX_BUF      256     // 控制台 UART 驱动缓冲（见 console_init）
+#define CONSOLE_TX_BUF      4096
 
 /* ================= 全局 ================= */
 static paramsMLX90640 mlx90640;
-static float mlx90640To[768];
+static mlx_frame_assembler_t assembler;
+
+/* 采集任务（core 1）→ 输出任务（core 0），帧缓冲来自 mlx_pool */
+static mlx_queue_t frame_queue;
+static mlx_buf_t *frame_filling;
+static TaskHandle_t output_task_handle;
+static QueueHandle_t metrics_mbox;      // 最新一条资源监控记录，由输出任务随帧发出
+
+/* 运行时配置，除 output_format / key_interval 外只由采集任务读写 */
+static uint8_t refresh_rate = REFRESH_RATE;
+static volatile uint8_t output_format = OUTPUT_BINARY;
+static volatile uint8_t key_interval = MLX_DELTA_DEFAULT_KEY_INTERVAL;
+static mlx_delta_enc_t delta_enc;       // 只由输出任务编码，统计由 stream_report 原子读出
+static volatile bool calib_pending;     // 输出任务下一个 raw 子页前先发标定包
+static uint32_t raw_seq;
+
+/* EEPROM 镜像：初始化后只读，raw 输出时作为标定包发给主机 */
+static MLX_COLD_BSS uint16_t ee_image[MLX90640_EEPROM_DUMP_NUM];
+static mlx_cmd_parser_t cmd_parser;
+
+typedef struct {
+    uint32_t count;
+    int64_t  sum_us;
+    int64_t  max_us;
+} stage_stat_t;
+
+typedef struct {
+    int64_t      window_start;
+    uint32_t     subpages;
+    uint32_t     frames;            // 拼好的整帧
+    uint32_t     dropped;           // 相邻两次读到同一子页，说明中间丢了一个
+    uint32_t     errors;
+    int          last_subpage;
+    stage_stat_t read;              // 等待 data-ready + 读 RAM
+    stage_stat_t calc;
+    stage_stat_t output;
+} stream_stats_t;
+
+static stream_stats_t stream_stats = { .last_subpage = -1 };
+
+/* 队列满 + 采集端正在填 1 帧 + 输出端正在用 1 帧 */
+_Static_assert(MLX_POOL_TEMP_COUNT >= MLX_QUEUE_DEPTH + 2, "frame pool smaller than queue");
+_Static_assert(MLX_POOL_RAW_COUNT >= MLX_QUEUE_DEPTH + 2, "raw pool smaller than queue");
+_Static_assert(MLX_POOL_RENDER_SIZE >= MLX_PROTO_WIRE_MAX(MLX_PROTO_FRAME_SIZE), "render buffer too small");
+_Static_assert(MLX_POOL_RENDER_SIZE >= MLX_PROTO_WIRE_MAX(MLX_PROTO_RAW_SIZE), "render buffer too small");
+_Static_assert(MLX_POOL_RENDER_SIZE >= MLX_PROTO_WIRE_MAX(MLX_PROTO_CALIB_SIZE), "render buffer too small");
+_Static_assert(MLX_POOL_RENDER_SIZE >= MLX_PROTO_WIRE_MAX(MLX_PROTO_METRICS_MAX), "render buffer too small");
+
+#if MLX90640_I2C_CAPTURE
+/* ================= I2C 录制输出 ================= */
+/* 录制时控制台的波特率，带宽估算见 MLX90640_I2C_Capture.h */
+#ifdef CONFIG_MLX90640_I2C_CAPTURE_BAUD
+#define CAPTURE_BAUD    CONFIG_MLX90640_I2C_CAPTURE_BAUD
+#else
+#define CAPTURE_BAUD    921600
+#endif
+
+/* 经 UART 驱动直接写，不经过 stdout 的换行转换（见 console_init） */
+static void capture_to_console(const void *buf, size_t len, void *ctx)
+{
+#if CONFIG_ESP_CONSOLE_UART
+    uart_write_bytes(CONFIG_ESP_CONSOLE_UART_NUM, buf, len);
+#endif
+}
+#endif
 
 /* ================= 按键初始化 ================= */
 static void button_init(void)
@@ -39,6 +163,642 @@ static void button_init(void)
     gpio_config(&io_conf);
 }
 
+/* 按下并松开后返回 true */
+static bool button_clicked(void)
+{
+    if (gpio_get_level(BOOT_BUTTON_GPIO) != 0) {
+        return false;
+    }
+    while (gpio_get_level(BOOT_BUTTON_GPIO) == 0) {
+        vTaskDelay(pdMS_TO_TICKS(50));
+    }
+    return true;
+}
+
+/* ================= 串口命令 ================= */
+/*
+ * 控制台 UART 装上驱动，stdio 改走同一个驱动：二进制数据用 uart_write_bytes 直接写，
+ * 不经过 newlib 的换行转换（CONFIG_NEWLIB_STDOUT_LINE_ENDING_CRLF 会把 0x0A 改成 0x0D 0x0A）。
+ */
+static void console_init(void)
+{
+#if CONFIG_ESP_CONSOLE_UART
+    fflush(stdout);
+    ESP_ERROR_CHECK(uart_driver_install(CONFIG_ESP_CONSOLE_UART_NUM, CONSOLE_RX_BUF, CONSOLE_TX_BUF,
+                                        0, NULL, 0));
+    uart_vfs_dev_use_driver(CONFIG_ESP_CONSOLE_UART_NUM);
+#else
+    fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+#endif
+    mlx_cmd_parser_init(&cmd_parser);
+}
+
+/*
+ * 命令帧是二进制的，同样不能经过 stdin：CONFIG_NEWLIB_STDIN_LINE_ENDING_CR
+ * 会把 0x0D 改成 0x0A，载荷或 crc8 里带 0x0D 的命令就被丢弃。不等待，没有数据返回 0
+ */
+static int console_read(uint8_t *buf, size_t len)
+{
+#if CONFIG_ESP_CONSOLE_UART
+    return uart_read_bytes(CONFIG_ESP_CONSOLE_UART_NUM, buf, len, 0);
+#else
+    return read(STDIN_FILENO, buf, len);
+#endif
+}
+
+static void log_config(void)
+{
+    ESP_LOGI(TAG, "config: refresh=%u resolution=%d pattern=%s emissivity=%.4f tr=%s%.2f output=%u keyframe=%u",
+             refresh_rate, MLX90640_GetCurResolution(MLX90640_ADDR),
+             MLX90640_GetCurMode(MLX90640_ADDR) ? "chess" : "interleaved",
+             assembler.emissivity, assembler.tr_fixed ? "" : "Ta-",
+             assembler.tr_fixed ? assembler.tr : assembler.ta_shift, output_format, key_interval);
+}
+
+/*
+ * 执行一条命令。返回 1 表示改了传感器寄存器，需要重同步子页；
+ * 0 表示成功但不涉及传感器；负数表示参数或 I2C 错误。
+ */
+static int apply_command(const mlx_cmd_t *cmd)
+{
+    int ret = -1;
+    uint8_t v = cmd->len >= 1 ? cmd->payload[0] : 0xFF;
+
+    switch (cmd->id) {
+    case MLX_CMD_SET_REFRESH:
+        if (cmd->len == 1 && v <= 7 && MLX90640_SetRefreshRate(MLX90640_ADDR, v) == 0) {
+            refresh_rate = v;
+            ret = 1;
+        }
+        break;
+    case MLX_CMD_SET_RESOLUTION:
+        if (cmd->len == 1 && v <= 3 && MLX90640_SetResolution(MLX90640_ADDR, v) == 0) {
+            ret = 1;
+        }
+        break;
+    case MLX_CMD_SET_PATTERN:
+        if (cmd->len == 1 && v <= 1) {
+            int err = v ? MLX90640_SetChessMode(MLX90640_ADDR) : MLX90640_SetInterleavedMode(MLX90640_ADDR);
+            ret = (err == 0) ? 1 : -1;
+        }
+        break;
+    case MLX_CMD_SET_EMISSIVITY:
+        if (cmd->len == 2) {
+            uint16_t e = mlx_cmd_u16(cmd, 0);
+            if (e >= 1000 && e <= 10000) {
+                assembler.emissivity = e / 10000.0f;
+                ret = 0;
+            }
+        }
+        break;
+    case MLX_CMD_SET_TR:
+        if (cmd->len == 3 && v <= 1) {
+            assembler.tr_fixed = v;
+            assembler.tr = (int16_t)mlx_cmd_u16(cmd, 1) / 100.0f;
+            ret = 0;
+        }
+        break;
+    case MLX_CMD_SET_OUTPUT:
+        if (cmd->len == 1 && v < OUTPUT_FORMATS) {
+            calib_pending = (v == OUTPUT_RAW);
+            output_format = v;
+            ret = 0;
+        }
+        break;
+    case MLX_CMD_SET_KEYFRAME:
+        if (cmd->len == 1) {
+            key_interval = v;
+            ret = 0;
+        }
+        break;
+    case MLX_CMD_GET_CONFIG:
+        ret = 0;
+        break;
+    case MLX_CMD_PROFILE_DUMP:
+        mlx_profile_dump();
+        return 0;
+    case MLX_CMD_PROFILE_RESET:
+        mlx_profile_reset();
+        return 0;
+    case MLX_CMD_TRACE_DUMP:
+        MLX90640_I2CTraceDump();
+        return 0;
+    default:
+        break;
+    }
+
+    if (ret < 0) {
+        ESP_LOGW(TAG, "cmd 0x%02x rejected", cmd->id);
+    } else {
+        log_config();
+    }
+    return ret;
+}
+
+/*
+ * 处理串口上已到达的全部命令（见 mlx_cmd.h），帧外的 'p' / 'r' 打印 / 清零分阶段耗时。
+ * 配置有变化时丢弃拼了一半的帧；改了传感器寄存器还要 SynchFrame，
+ * 旧配置下的子页不会混进新帧，代价最多是一个整帧。返回是否做了重同步。
+ */
+static bool console_poll(void)
+{
+    bool resync = false;
+    bool changed = false;
+    uint8_t buf[32];
+    int n;
+
+    while ((n = console_read(buf, sizeof(buf))) > 0) {
+        for (int i = 0; i < n; i++) {
+            mlx_cmd_t cmd;
+            int r = mlx_cmd_parse_byte(&cmd_parser, buf[i], &cmd);
+            if (r == MLX_CMD_COMPLETE) {
+                int ret = apply_command(&cmd);
+                changed |= (ret >= 0);
+                resync |= (ret > 0);
+            } else if (r == MLX_CMD_OUTSIDE && buf[i] == 'p') {
+                mlx_profile_dump();
+            } else if (r == MLX_CMD_OUTSIDE && buf[i] == 'r') {
+                mlx_profile_reset();
+            }
+        }
+    }
+
+    if (changed) {
+        stream_stats.last_subpage = -1;
+        mlx_frame_assembler_reset(&assembler);
+    }
+    if (resync) {
+        MLX90640_SynchFrame(MLX90640_ADDR);
+    }
+    return resync;
+}
+
+/* ================= 统计 ================= */
+static void stage_add(stage_stat_t *s, int64_t us)
+{
+    s->count++;
+    s->sum_us += us;
+    if (us > s->max_us) {
+        s->max_us = us;
+    }
+}
+
+static void stream_report(int64_t now)
+{
+    stream_stats_t *st = &stream_stats;
+    float secs = (now - st->window_start) / 1e6f;
+
+    /* 恢复计数是启动以来的累计值 */
+    mlx90640_i2c_recovery_stats_t rs;
+    MLX90640_I2CGetRecoveryStats(&rs);
+
+    ESP_LOGI(TAG, "%.1f subpages/s  %.1f frames/s  dropped=%" PRIu32 "  errors=%" PRIu32
+             "  queue drops=%" PRIu32 "  recoveries=%" PRIu32 " (bus clears %" PRIu32
+             ", failed %" PRIu32 ", max %" PRIu32 "us)",
+             st->subpages / secs, st->frames / secs, st->dropped, st->errors,
+             frame_queue.drops, rs.events, rs.bus_clears, rs.failures, rs.max_us);
+
+    const struct { const char *name; stage_stat_t *s; } stages[] = {
+        { "read",   &st->read },
+        { "calc",   &st->calc },
+        { "output", &st->output },
+    };
+    for (int i = 0; i < 3; i++) {
+        stage_stat_t *s = stages[i].s;
+        if (s->count) {
+            ESP_LOGI(TAG, "  %-6s avg=%" PRId64 "us max=%" PRId64 "us",
+                     stages[i].name, s->sum_us / s->count, s->max_us);
+        }
+    }
+
+    for (int i = 0; i < MLX_POOL_CLASSES; i++) {
+        mlx_pool_stats_t ps;
+        mlx_pool_get_stats(i, &ps);
+        ESP_LOGI(TAG, "  pool %-6s %" PRIu32 "/%" PRIu32 " in use, peak %" PRIu32 ", alloc fail %" PRIu32,
+                 mlx_pool_class_name(i), ps.in_use, ps.capacity, ps.high_water, ps.alloc_fail);
+    }
+
+    mlx_delta_stats_t ds;
+    mlx_delta_get_stats(&delta_enc, &ds);
+    if (ds.frames && ds.coded_bytes) {
+        ESP_LOGI(TAG, "  delta  ratio=%.2f  keyframes=%" PRIu32 "/%" PRIu32 "  %" PRIu32 " B/frame",
+                 (float)ds.raw_bytes / ds.coded_bytes, ds.keyframes, ds.frames,
+                 (uint32_t)(ds.coded_bytes / ds.frames));
+    }
+
+#if OUTPUT_PORT == OUTPUT_PORT_USB
+    mlx_usbout_stats_t us;
+    mlx_usbout_get_stats(&us);
+    ESP_LOGI(TAG, "  usb    %.1f KB/s  %.1f pkts/s  drops=%" PRIu32 "  max write=%" PRIu32 "us",
+             us.bytes / 1024.0f / secs, us.packets / secs, us.drops, us.max_write_us);
+#endif
+
+    /* 日志里一行，帧口上一个包（由输出任务写，不与帧交错） */
+    mlx_sysmon_record_t rec;
+    mlx_sysmon_sample(&rec);
+    mlx_sysmon_emit(&rec);
+    xQueueOverwrite(metrics_mbox, &rec);
+    xTaskNotifyGive(output_task_handle);
+
+    // 与输出格式无关；未开启 MLX90640_I2C_TRACE 时为空操作
+    MLX90640_I2CTraceDump();
+
+#if CONFIG_MLX_PROFILE_REPORT
+    mlx_profile_dump();
+    mlx_profile_reset();
+#endif
+
+    int last = st->last_subpage;
+    memset(st, 0, sizeof(*st));
+    st->last_subpage = last;
+    st->window_start = now;
+}
+
+/* ================= 内存布局 ================= */
+
+/* 启动时确认热路径的实际位置（策略见 mlx_placement.h / linker.lf） */
+static void log_placement(void)
+{
+    ESP_LOGI(TAG, "placement: CalculateTo=%s assembler=%s params=%s frames=%s",
+             esp_ptr_in_iram((const void *)MLX90640_CalculateTo) ? "IRAM" : "flash",
+             esp_ptr_in_iram((const void *)mlx_frame_assembler_push) ? "IRAM" : "flash",
+             esp_ptr_internal(&mlx90640) ? "internal" : "PSRAM",
+             esp_ptr_internal(frame_filling->data) ? "internal" : "PSRAM");
+}
+
+/* ================= 帧处理 ================= */
+static void print_frame(const mlx_frame_t *f)
+{
+    ESP_LOGI(TAG, "#%" PRIu32 " Ta=%.2fC  Vdd=%.2fV  Full frame:", f->seq, f->ta, f->vdd);
+
+    // 输出768个像素
+    // for (int i = 0; i < 768; i++) {
+    //     ESP_LOGI(TAG, "Pixel[%d]: %.2f C", i, f->to[i]);
+    // }
+
+    ESP_LOGI(TAG, "Full frame (24x32):");
+
+    mlx_buf_t *rb = mlx_pool_alloc(MLX_POOL_RENDER);
+    if (rb == NULL) {
+        return;
+    }
+    char *line = rb->data;
+    int64_t encode_us = 0, output_us = 0;
+
+    for (int row = 0; row < 24; row++) {
+        int64_t tp = mlx_profile_now();
+        int len = 0;
+
+        len += snprintf(line + len, rb->size - len,
+                        "Row %02d: ", row);
+
+        for (int col = 0; col < 32; col++) {
+            int idx = row * 32 + col;
+            len += snprintf(line + len, rb->size - len,
+                            "%6.2f ", f->to[idx]);
+        }
+
+        int64_t te = mlx_profile_now();
+        ESP_LOGI(TAG, "%s", line);
+        encode_us += te - tp;
+        output_us += mlx_profile_now() - te;
+    }
+
+    mlx_buf_unref(rb);
+    mlx_profile_record(MLX_PROF_ENCODE, encode_us);
+    mlx_profile_record(MLX_PROF_OUTPUT, output_us);
+}
+
+/* mlx_s3.py 的格式：不带日志前缀，每行一行像素 */
+static void print_frame_csv(const mlx_frame_t *f)
+{
+    mlx_buf_t *rb = mlx_pool_alloc(MLX_POOL_RENDER);
+    if (rb == NULL) {
+        return;
+    }
+    char *line = rb->data;
+    int64_t encode_us = 0, output_us = 0;
+
+    fputs("FRAME_BEGIN\n", stdout);
+    for (int row = 0; row < 24; row++) {
+        int64_t tp = mlx_profile_now();
+        int len = 0;
+
+        for (int col = 0; col < 32; col++) {
+            len += snprintf(line + len, rb->size - len, col ? ",%.2f" : "%.2f", f->to[row * 32 + col]);
+        }
+        line[len++] = '\n';
+
+        int64_t te = mlx_profile_now();
+        fwrite(line, 1, len, stdout);
+        encode_us += te - tp;
+        output_us += mlx_profile_now() - te;
+    }
+    fputs("FRAME_END\n", stdout);
+    fflush(stdout);
+
+    mlx_buf_unref(rb);
+    mlx_profile_record(MLX_PROF_ENCODE, encode_us);
+    mlx_profile_record(MLX_PROF_OUTPUT, output_us);
+}
+
+/* 总线错误：恢复总线并重同步子页，只丢这一帧 */
+static void recover_bus(void)
+{
+    ESP_LOGW(TAG, "I2C error, recovering");
+    stream_stats.errors++;
+    stream_stats.last_subpage = -1;
+    mlx_frame_assembler_reset(&assembler);
+    if (MLX90640_I2CRecover() == 0) {
+        MLX90640_SynchFrame(MLX90640_ADDR);
+    }
+}
+
+/* 读一个子页并计算温度，拼好整帧后交给输出任务；返回 GetFrameData 的结果 */
+static int process_subpage(void)
+{
+    if (frame_filling == NULL) {
+        frame_filling = mlx_pool_alloc(MLX_POOL_TEMP);
+    }
+    mlx_buf_t *raw = mlx_pool_alloc(MLX_POOL_RAW);
+    if (raw == NULL || frame_filling == NULL) {
+        /* 池容量与队列深度匹配时不会发生 */
+        ESP_LOGW(TAG, "frame pool exhausted");
+        mlx_buf_unref(raw);
+        stream_stats.errors++;
+        return -1;
+    }
+    mlx_raw_frame_t *rf = raw->data;
+    uint16_t *frame = rf->words;
+
+    int64_t t0 = esp_timer_get_time();
+    int ret = MLX90640_GetFrameData(MLX90640_ADDR, frame);
+    int64_t t1 = esp_timer_get_time();
+
+    if (ret == -MLX90640_I2C_NACK_ERROR) {
+        recover_bus();
+        mlx_buf_unref(raw);
+        return ret;
+    } else if (ret < 0) {
+        ESP_LOGW(TAG, "Frame error: %d", ret);
+        stream_stats.errors++;
+        mlx_buf_unref(raw);
+        return ret;
+    }
+
+    if (stream_stats.last_subpage == ret) {
+        stream_stats.dropped++;
+    }
+    stream_stats.last_subpage = ret;
+
+    if (output_format == OUTPUT_RAW) {
+        /* 原始子页直接入队，标定和拼帧留给主机 */
+        rf->seq = raw_seq++;
+        rf->t_us = t1;
+        mlx_buf_unref(mlx_queue_publish(&frame_queue, raw));
+        xTaskNotifyGive(output_task_handle);
+        stream_stats.subpages++;
+        stage_add(&stream_stats.read, t1 - t0);
+        return ret;
+    }
+
+    bool full = mlx_frame_assembler_push(&assembler, frame, t1, frame_filling->data);
+    int64_t t2 = esp_timer_get_time();
+    mlx_buf_unref(raw);
+
+    if (full) {
+        /* 输出跟不上时队列丢弃最旧的帧，采集不会被阻塞 */
+        mlx_buf_unref(mlx_queue_publish(&frame_queue, frame_filling));
+        frame_filling = mlx_pool_alloc(MLX_POOL_TEMP);
+        xTaskNotifyGive(output_task_handle);
+    }
+
+    stream_stats.subpages++;
+    stream_stats.frames += full;
+    stage_add(&stream_stats.read, t1 - t0);
+    stage_add(&stream_stats.calc, t2 - t1);
+
+    return ret;
+}
+
+/* ================= 输出任务 ================= */
+/*
+ * 二进制包
+ * USB 口整包进驱动的 TX 环形缓冲，主机跟不上时整包丢弃（见 usb 统计行），返回 false。
+ * 控制台口不能用 stdout：newlib 的 CRLF 转换会改写包里的 0x0A，CRC 校验失败；
+ * 而且每个任务有自己的 stdout FILE 和锁，别的任务的日志照样写到同一个 UART。
+ * 这里直接 uart_write_bytes（驱动见 console_init）：一次调用持有驱动的 TX 锁直到整包
+ * 进入缓冲，日志只会落在两个包之间（日志经 VFS 逐字节写驱动），主机按 0x00 分隔丢弃。
+ */
+static bool write_packet(const uint8_t *data, size_t len)
+{
+#if OUTPUT_PORT == OUTPUT_PORT_USB
+    return mlx_usbout_write(data, len);
+#elif CONFIG_ESP_CONSOLE_UART
+    return uart_write_bytes(CONFIG_ESP_CONSOLE_UART_NUM, data, len) == (int)len;
+#else
+    return false;
+#endif
+}
+
+/* 差分模式下丢包后下一帧改发关键帧 */
+static void print_frame_binary(const mlx_frame_t *f, bool delta)
+{
+    mlx_buf_t *rb = mlx_pool_alloc(MLX_POOL_RENDER);
+    if (rb == NULL) {
+        return;
+    }
+
+    int64_t tp = mlx_profile_now();
+    size_t len = delta ? mlx_delta_encode(&delta_enc, f, key_interval, rb->data)
+                       : mlx_proto_encode_frame(f, rb->data);
+    int64_t te = mlx_profile_now();
+    if (!write_packet(rb->data, len) && delta) {
+        mlx_delta_force_key(&delta_enc);
+    }
+
+    mlx_profile_record(MLX_PROF_ENCODE, te - tp);
+    mlx_profile_record(MLX_PROF_OUTPUT, mlx_profile_now() - te);
+    mlx_buf_unref(rb);
+}
+
+static void output_frame(const mlx_frame_t *f)
+{
+    const uint32_t print_every = (ACQ_MODE == ACQ_MODE_STREAM) ? PRINT_EVERY : 1;
+    int64_t t0 = esp_timer_get_time();
+    uint8_t format = output_format;
+
+    bool binary = (format == OUTPUT_BINARY || format == OUTPUT_DELTA);
+
+    /* 切到 raw 之前已拼好的温度帧不再输出 */
+    if (format == OUTPUT_OFF || format == OUTPUT_RAW || (!binary && f->seq % print_every != 0)) {
+        return;
+    }
+    if (binary) {
+        print_frame_binary(f, format == OUTPUT_DELTA);
+    } else if (format == OUTPUT_CSV) {
+        print_frame_csv(f);
+    } else {
+        print_frame(f);
+    }
+    stage_add(&stream_stats.output, esp_timer_get_time() - t0);
+}
+
+/* 原始子页：必要时先补发标定包，发不出去就下次再试 */
+static void output_raw(const mlx_raw_frame_t *rf)
+{
+    int64_t t0 = esp_timer_get_time();
+    mlx_buf_t *rb = mlx_pool_alloc(MLX_POOL_RENDER);
+    if (rb == NULL) {
+        return;
+    }
+
+    if (calib_pending || rf->seq % CALIB_EVERY == 0) {
+        size_t len = mlx_proto_encode_calib(ee_image, rb->data);
+        calib_pending = !write_packet(rb->data, len);
+    }
+    write_packet(rb->data, mlx_proto_encode_raw(rf, rb->data));
+
+    mlx_buf_unref(rb);
+    stage_add(&stream_stats.output, esp_timer_get_time() - t0);
+}
+
+/* 资源监控包：只在二进制输出时随帧发送，文本输出看日志里的 METRICS 行 */
+static void output_metrics(const mlx_sysmon_record_t *rec)
+{
+    uint8_t format = output_format;
+    if (format != OUTPUT_BINARY && format != OUTPUT_DELTA && format != OUTPUT_RAW) {
+        return;
+    }
+    mlx_buf_t *rb = mlx_pool_alloc(MLX_POOL_RENDER);
+    if (rb == NULL) {
+        return;
+    }
+    write_packet(rb->data, mlx_proto_encode_metrics(rec, rb->data));
+    mlx_buf_unref(rb);
+}
+
+static void output_task(void *arg)
+{
+    static mlx_sysmon_record_t metrics;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        mlx_buf_t *buf;
+        while ((buf = mlx_queue_take(&frame_queue)) != NULL) {
+            if (buf->cls == MLX_POOL_RAW) {
+                output_raw(buf->data);
+            } else {
+                output_frame(buf->data);
+            }
+            mlx_buf_unref(buf);
+        }
+        if (xQueueReceive(metrics_mbox, &metrics, 0) == pdTRUE) {
+            output_metrics(&metrics);
+        }
+    }
+}
+
+#if ACQ_MODE == ACQ_MODE_LOWPOWER
+/* ================= 低功耗 ================= */
+static int64_t lp_now(void *ctx)
+{
+    return esp_timer_get_time();
+}
+
+/*
+ * 睡前把控制台和 USB 口都发完，否则 light sleep 期间外设停摆会截断输出。
+ * USB 主机连着但没读完时这个周期不睡，改为普通延时（step 的功耗估算会偏低）
+ */
+static void lp_light_sleep(int64_t us, void *ctx)
+{
+    int64_t t0 = esp_timer_get_time();
+
+    fflush(stdout);
+#if CONFIG_ESP_CONSOLE_UART
+    /* 装了驱动后数据可能还在驱动的 TX 缓冲里，只等硬件空闲不够 */
+    uart_wait_tx_done(CONFIG_ESP_CONSOLE_UART_NUM, pdMS_TO_TICKS(us / 1000));
+#endif
+#if OUTPUT_PORT == OUTPUT_PORT_USB
+    bool drained = mlx_usbout_wait_tx_done(us / 1000);
+#else
+    bool drained = true;
+#endif
+
+    us -= esp_timer_get_time() - t0;
+    if (us <= 0) {
+        return;
+    }
+    if (!drained) {
+        vTaskDelay(pdMS_TO_TICKS(us / 1000));
+        return;
+    }
+    esp_sleep_enable_timer_wakeup((uint64_t)us);
+    esp_light_sleep_start();
+}
+
+static void lowpower_loop(void)
+{
+    mlx_step_t step;
+    mlx_step_report_t rep;
+    mlx_buf_t *raw = mlx_pool_alloc(MLX_POOL_RAW);
+    mlx_buf_t *out = mlx_pool_alloc(MLX_POOL_TEMP);
+
+    mlx_step_init(&step, MLX90640_ADDR, lp_now, lp_light_sleep, NULL);
+    if (mlx_step_enable(&step, true) != 0) {
+        ESP_LOGE(TAG, "step mode enable failed");
+        vTaskDelete(NULL);
+    }
+
+    ESP_LOGI(TAG, "Low-power capture every %d ms, conversion %" PRId64 " us per subpage",
+             LP_CAPTURE_PERIOD_US / 1000, step.conv_us);
+
+    int64_t next = esp_timer_get_time();
+    uint32_t n = 0;
+
+    while (1) {
+        /* light sleep 期间到达的命令字节会丢失，命令需在唤醒窗口内发送 */
+        if (console_poll()) {
+            mlx_step_enable(&step, true);
+        }
+
+        mlx_raw_frame_t *rf = raw->data;
+        int ret = mlx_step_capture(&step, &assembler, rf->words, out->data);
+        if (ret == -MLX90640_I2C_NACK_ERROR) {
+            recover_bus();
+            mlx_step_enable(&step, true);
+        } else if (ret == 0) {
+            output_frame(out->data);
+        } else {
+            ESP_LOGW(TAG, "Capture error: %d", ret);
+        }
+
+        if (++n % LP_REPORT_EVERY == 0) {
+            mlx_step_report(&step, LP_ACTIVE_MA, LP_SLEEP_MA, &rep);
+            ESP_LOGI(TAG, "%" PRIu32 " captures (errors %" PRIu32 ", timeouts %" PRIu32 "): "
+                     "awake %.1f ms / %.0f ms, polls %.1f, duty %.2f%%, est. avg %.2f mA",
+                     rep.captures, rep.errors, rep.timeouts, rep.awake_ms, rep.period_ms, rep.polls,
+                     rep.duty * 100, rep.avg_ma);
+
+            /* 低功耗模式下帧也由本任务直接输出，监控包同样直接写 */
+            mlx_sysmon_record_t rec;
+            mlx_sysmon_sample(&rec);
+            mlx_sysmon_emit(&rec);
+            output_metrics(&rec);
+        }
+
+        /* 错过的周期直接跳过，不连续补采 */
+        next += LP_CAPTURE_PERIOD_US;
+        int64_t now = esp_timer_get_time();
+        while (next <= now) {
+            next += LP_CAPTURE_PERIOD_US;
+        }
+        mlx_step_sleep_until(&step, next);
+    }
+}
+#endif
+
 /* ================= 任务 ================= */
 static void mlx90640_task(void *arg)
 {
@@ -47,9 +807,21 @@ static void mlx90640_task(void *arg)
     /* 初始化 I2C（在 I2C driver 内部完成） */
     ESP_ERROR_CHECK(MLX90640_I2CInit());
 
-    uint16_t eeData[832];
-
-    int ret = MLX90640_DumpEE(MLX90640_ADDR, eeData);
+#if MLX90640_I2C_CAPTURE
+    /*
+     * 录制模式：此后控制台只输出二进制日志，并切到 CAPTURE_BAUD，
+     * 主机端按这个波特率直接保存串口数据即可（回放时跳过前面的启动日志）
+     */
+    esp_log_level_set("*", ESP_LOG_NONE);
+    fflush(stdout);
+#if CONFIG_ESP_CONSOLE_UART
+    uart_wait_tx_done(CONFIG_ESP_CONSOLE_UART_NUM, pdMS_TO_TICKS(100));
+    uart_set_baudrate(CONFIG_ESP_CONSOLE_UART_NUM, CAPTURE_BAUD);
+#endif
+    MLX90640_I2CCaptureStart(capture_to_console, NULL);
+#endif
+
+    int ret = MLX90640_DumpEE(MLX90640_ADDR, ee_image);
     if (ret != 0) {
         ESP_LOGE(TAG, "EEPROM read failed: %d", ret);
         vTaskDelete(NULL);
@@ -57,70 +829,88 @@ static void mlx90640_task(void *arg)
 
     ESP_LOGI(TAG, "EEPROM OK");
 
-    ret = MLX90640_ExtractParameters(eeData, &mlx90640);
+    ret = MLX90640_ExtractParameters(ee_image, &mlx90640);
     if (ret != 0) {
         ESP_LOGE(TAG, "ExtractParameters failed: %d", ret);
         vTaskDelete(NULL);
     }
 
     ESP_LOGI(TAG, "Parameters extracted");
+    log_placement();
 
-    MLX90640_SetRefreshRate(MLX90640_ADDR, 0x04); // 4Hz
-
-    while (1) {
-        // 检测按键按下
-        if (gpio_get_level(BOOT_BUTTON_GPIO) == 0) {
-            ESP_LOGI(TAG, "Button pressed, reading full MLX90640 frame...");
-
-            uint16_t frame[834];
-            ret = MLX90640_GetFrameData(MLX90640_ADDR, frame);
-            if (ret < 0) {
-                ESP_LOGW(TAG, "Frame error: %d", ret);
-            } else {
-                float Ta  = MLX90640_GetTa(frame, &mlx90640);
-                float vdd = MLX90640_GetVdd(frame, &mlx90640);
-
-                float tr = Ta - TA_SHIFT;
-                MLX90640_CalculateTo(frame, &mlx90640, 0.95f, tr, mlx90640To);
-
-                ESP_LOGI(TAG, "Ta=%.2fC  Vdd=%.2fV  Full frame:", Ta, vdd);
+    mlx_frame_assembler_init(&assembler, &mlx90640, EMISSIVITY, TA_SHIFT);
 
-                // 输出768个像素
-                // for (int i = 0; i < 768; i++) {
-                //     ESP_LOGI(TAG, "Pixel[%d]: %.2f C", i, mlx90640To[i]);
-                // }
+    MLX90640_SetRefreshRate(MLX90640_ADDR, refresh_rate);
+    log_config();
 
-                ESP_LOGI(TAG, "Full frame (24x32):");
+#if ACQ_MODE == ACQ_MODE_LOWPOWER
+    lowpower_loop();
+#elif ACQ_MODE == ACQ_MODE_STREAM
+    int64_t period_us = 2000000 >> refresh_rate;
+    bool paused = false;
+    mlx_sched_t sched;
 
-                for (int row = 0; row < 24; row++) {
-                    char line[512];
-                    int len = 0;
+    mlx_sched_init(&sched, period_us, WAKE_MARGIN_US);
 
-                    len += snprintf(line + len, sizeof(line) - len,
-                                    "Row %02d: ", row);
+    ESP_LOGI(TAG, "Streaming, subpage period %" PRId64 " us. Press BOOT to pause.", period_us);
 
-                    for (int col = 0; col < 32; col++) {
-                        int idx = row * 32 + col;
-                        len += snprintf(line + len, sizeof(line) - len,
-                                        "%6.2f ", mlx90640To[idx]);
-                    }
+    MLX90640_SynchFrame(MLX90640_ADDR);
+    stream_stats.window_start = esp_timer_get_time();
 
-                    ESP_LOGI(TAG, "%s", line);
-                }
-
-
-            }
+    while (1) {
+        if (console_poll()) {
+            period_us = 2000000 >> refresh_rate;
+            mlx_sched_init(&sched, period_us, WAKE_MARGIN_US);
+        }
+        if (button_clicked()) {
+            paused = !paused;
+            stream_stats.last_subpage = -1;
+            mlx_frame_assembler_reset(&assembler);
+            mlx_sched_unlock(&sched);
+            ESP_LOGI(TAG, paused ? "Paused." : "Resumed.");
+        }
+        if (paused) {
+            vTaskDelay(pdMS_TO_TICKS(50));
+            continue;
+        }
 
-            // 等待按键松开
-            while (gpio_get_level(BOOT_BUTTON_GPIO) == 0) {
-                vTaskDelay(pdMS_TO_TICKS(50));
-            }
+        /* 睡到预测的 data-ready 前 WAKE_MARGIN_US，轮询到就绪后 GetFrameData 不再等待 */
+        int ret = mlx_sched_wait_ready(&sched, MLX90640_ADDR);
+        if (ret == 0) {
+            ret = process_subpage();
+        } else {
+            recover_bus();
+        }
+        if (ret == -MLX90640_I2C_NACK_ERROR) {
+            mlx_sched_unlock(&sched);   // 总线恢复时做了 SynchFrame，相位已变
+        }
 
+        int64_t now = esp_timer_get_time();
+        if (ret >= 0) {
+            mlx_sched_frame_done(&sched, now);
+        }
+        if (now - stream_stats.window_start >= STATS_PERIOD_US) {
+            stream_report(now);
+            mlx_sched_report(&sched);
+        }
+    }
+#else
+    while (1) {
+        console_poll();
+        // 检测按键按下
+        if (button_clicked()) {
+            ESP_LOGI(TAG, "Button pressed, reading full MLX90640 frame...");
+            stream_stats.last_subpage = -1;
+            mlx_frame_assembler_reset(&assembler);
+            /* 两个相邻子页拼成一整帧 */
+            process_subpage();
+            process_subpage();
             ESP_LOGI(TAG, "Ready for next press.");
         }
 
         vTaskDelay(pdMS_TO_TICKS(50)); // 50ms轮询按键
     }
+#endif
 }
 
 /* ================= app_main ================= */
@@ -140,6 +930,26 @@ void app_main(void)
     gpio_set_level(I2C_PULL_GPIO, 0); // 低电平=使能上拉
 
     button_init();
+    console_init();
+#if OUTPUT_PORT == OUTPUT_PORT_USB
+    ESP_ERROR_CHECK(mlx_usbout_init(USBOUT_TIMEOUT_MS));
+#endif
+
+    mlx_pool_init();
+    mlx_queue_init(&frame_queue);
+    mlx_delta_init(&delta_enc);
+    metrics_mbox = xQueueCreate(1, sizeof(mlx_sysmon_record_t));
+    frame_filling = mlx_pool_alloc(MLX_POOL_TEMP);
+
+    xTaskCreatePinnedToCore(
+        output_task,
+        "mlx_output",
+        4096,
+        NULL,
+        4,
+        &output_task_handle,
+        0
+    );
 
     xTaskCreatePinnedToCore(
         mlx90640_task,
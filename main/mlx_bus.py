@@ -0,0 +1,167 @@
+"""
+共享内存帧总线的 Python 读端（布局见 host/mlx_bus.h，写端是 host/mlx_busd）
+
+  bus = BusReader()                   # 默认 /dev/shm/mlx90640
+  for frame in bus:                   # mlx_proto.Frame，frame.to 为拷贝出来的 (24, 32)
+      ...
+
+  slot = bus.peek()                   # 零拷贝：共享内存上的只读视图
+  hot = slot["to"].max()
+  if bus.done():                      # 期间没被写端覆盖，结果有效
+      ...
+
+与 mlx_receiver.Receiver 接口相近（get / take / __iter__ / stats），
+查看器可以直接换成总线输入，多个进程同时看同一路传感器。
+"""
+import mmap
+import os
+import time
+
+import numpy as np
+
+from mlx_proto import COLS, ROWS, Frame
+
+MAGIC = 0x42584C4D      # "MLXB"
+VERSION = 1
+DEFAULT_NAME = "/mlx90640"
+
+HEADER = np.dtype([
+    ("magic", "<u4"), ("version", "<u2"), ("header_size", "<u2"), ("slots", "<u4"),
+    ("slot_size", "<u4"), ("writer_pid", "<i4"), ("closed", "<u4"), ("notify", "<u4"),
+    ("reserved0", "<u4"), ("head", "<u8"), ("reserved", "u1", 24),
+])
+SLOT_FIELDS = [
+    ("bus_seq", "<u8"), ("seq", "<u4"), ("ctrl", "<u2"), ("subpage", "u1"), ("reserved", "u1"),
+    ("t_first_us", "<i8"), ("t_last_us", "<i8"), ("ta", "<f4"), ("vdd", "<f4"),
+    ("to", "<f4", (ROWS, COLS)),
+]
+assert HEADER.itemsize == 64
+
+
+class BusClosed(Exception):
+    pass
+
+
+class BusReader:
+    def __init__(self, name=DEFAULT_NAME, poll=0.002):
+        path = "/dev/shm/" + name.lstrip("/")
+        fd = os.open(path, os.O_RDONLY)
+        try:
+            self.mm = mmap.mmap(fd, 0, prot=mmap.PROT_READ)
+        finally:
+            os.close(fd)
+        self.poll = poll
+
+        hdr = np.frombuffer(self.mm, dtype=HEADER, count=1)
+        h = hdr[0]
+        if h["magic"] != MAGIC or h["version"] != VERSION or h["slots"] < 2:
+            raise ValueError(f"{path}: not a frame bus")
+        self.nslots = int(h["slots"])
+        dtype = np.dtype({"names": [f[0] for f in SLOT_FIELDS],
+                          "formats": [f[1] if len(f) == 2 else (f[1], f[2]) for f in SLOT_FIELDS],
+                          "itemsize": int(h["slot_size"])})
+        self.slots = np.frombuffer(self.mm, dtype=dtype, count=self.nslots, offset=int(h["header_size"]))
+
+        # head / closed / bus_seq 用单独的视图读，每次都从共享内存取最新值
+        self._head = np.frombuffer(self.mm, dtype="<u8", count=1, offset=HEADER.fields["head"][1])
+        self._closed = np.frombuffer(self.mm, dtype="<u4", count=1, offset=HEADER.fields["closed"][1])
+        self._bus_seq = self.slots["bus_seq"]
+
+        head = int(self._head[0])
+        self.next = head if head else 1
+        self._cur = None
+        self.frames = 0
+        self.lost = 0
+        self.overruns = 0
+
+    @property
+    def stats(self):
+        return {"frames": self.frames, "lost": self.lost, "overruns": self.overruns}
+
+    @property
+    def closed(self):
+        return bool(self._closed[0])
+
+    def peek(self):
+        """下一帧所在槽位的只读视图（numpy 结构化标量），没有新帧返回 None；用完调用 done()"""
+        while True:
+            head = int(self._head[0])
+            if self.next > head:
+                return None
+            if head - self.next >= self.nslots:
+                self.lost += head - self.next
+                self.next = head
+            i = self.next % self.nslots
+            if int(self._bus_seq[i]) == self.next:
+                self._cur = i
+                return self.slots[i]
+            self.overruns += 1
+            self.next += 1
+
+    def done(self):
+        """peek 之后调用：数据在使用期间没被覆盖返回 True"""
+        ok = int(self._bus_seq[self._cur]) == self.next
+        self.next += 1
+        self._cur = None
+        if ok:
+            self.frames += 1
+        else:
+            self.overruns += 1
+        return ok
+
+    def read(self):
+        """拷贝出下一帧（mlx_proto.Frame），没有新帧返回 None"""
+        while True:
+            s = self.peek()
+            if s is None:
+                return None
+            frame = Frame(int(s["seq"]), int(s["t_last_us"]), float(s["ta"]), float(s["vdd"]),
+                          int(s["ctrl"]), int(s["subpage"]), s["to"].copy())
+            if self.done():
+                return frame
+
+    def get(self, timeout=None):
+        """等下一帧；超时返回 None，写端退出且没有剩余帧抛 BusClosed"""
+        deadline = None if timeout is None else time.monotonic() + timeout
+        while True:
+            frame = self.read()
+            if frame is not None:
+                return frame
+            if self.closed:
+                raise BusClosed()
+            if deadline is not None and time.monotonic() >= deadline:
+                return None
+            time.sleep(self.poll)
+
+    def take(self):
+        """只要最新一帧：跳过积压的帧（计入 lost）"""
+        head = int(self._head[0])
+        if head >= self.next + 1:
+            self.lost += head - self.next
+            self.next = head
+        return self.read()
+
+    def __iter__(self):
+        try:
+            while True:
+                yield self.get()
+        except BusClosed:
+            return
+
+    def close(self):
+        self.slots = self._head = self._closed = self._bus_seq = None
+        self.mm.close()
+
+
+if __name__ == "__main__":
+    # python mlx_bus.py [名字]    每秒打印一次收帧统计
+    import sys
+
+    bus = BusReader(sys.argv[1] if len(sys.argv) > 1 else DEFAULT_NAME)
+    t0, n0 = time.monotonic(), 0
+    for frame in bus:
+        t = time.monotonic()
+        if t - t0 >= 1.0:
+            print(f"seq {frame.seq}  {(bus.frames - n0) / (t - t0):.1f} fps  lost {bus.lost}  "
+                  f"overruns {bus.overruns}  max {frame.to.max():.2f}")
+            t0, n0 = t, bus.frames
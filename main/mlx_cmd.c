@@ -0,0 +1,97 @@
+#include "mlx_cmd.h"
+
+#include <string.h>
+
+enum {
+    ST_IDLE = 0,
+    ST_ID,
+    ST_LEN,
+    ST_PAYLOAD,
+    ST_CRC,
+};
+
+uint8_t mlx_cmd_crc8(const uint8_t *data, size_t len)
+{
+    uint8_t crc = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/* ================= 编码 ================= */
+size_t mlx_cmd_encode(const mlx_cmd_t *cmd, uint8_t *out)
+{
+    out[0] = MLX_CMD_SYNC;
+    out[1] = cmd->id;
+    out[2] = cmd->len;
+    memcpy(&out[3], cmd->payload, cmd->len);
+    out[3 + cmd->len] = mlx_cmd_crc8(&out[1], 2 + cmd->len);
+    return 4 + cmd->len;
+}
+
+/* ================= 解析 ================= */
+void mlx_cmd_parser_init(mlx_cmd_parser_t *p)
+{
+    memset(p, 0, sizeof(*p));
+}
+
+int mlx_cmd_parse_byte(mlx_cmd_parser_t *p, uint8_t b, mlx_cmd_t *out)
+{
+    /* 任意位置的同步字节都重新开始，半帧不会吞掉下一帧 */
+    if (b == MLX_CMD_SYNC && p->state != ST_PAYLOAD && p->state != ST_CRC) {
+        p->state = ST_ID;
+        return MLX_CMD_PENDING;
+    }
+
+    switch (p->state) {
+    case ST_IDLE:
+        return MLX_CMD_OUTSIDE;
+
+    case ST_ID:
+        p->cmd.id = b;
+        p->state = ST_LEN;
+        return MLX_CMD_PENDING;
+
+    case ST_LEN:
+        if (b > MLX_CMD_MAX_PAYLOAD) {
+            p->bad_len++;
+            p->state = ST_IDLE;
+            return MLX_CMD_PENDING;
+        }
+        p->cmd.len = b;
+        p->pos = 0;
+        p->state = b ? ST_PAYLOAD : ST_CRC;
+        return MLX_CMD_PENDING;
+
+    case ST_PAYLOAD:
+        p->cmd.payload[p->pos++] = b;
+        if (p->pos == p->cmd.len) {
+            p->state = ST_CRC;
+        }
+        return MLX_CMD_PENDING;
+
+    case ST_CRC: {
+        uint8_t hdr[2 + MLX_CMD_MAX_PAYLOAD];
+        hdr[0] = p->cmd.id;
+        hdr[1] = p->cmd.len;
+        memcpy(&hdr[2], p->cmd.payload, p->cmd.len);
+
+        p->state = ST_IDLE;
+        if (mlx_cmd_crc8(hdr, 2 + p->cmd.len) != b) {
+            p->bad_crc++;
+            return MLX_CMD_PENDING;
+        }
+        p->frames++;
+        *out = p->cmd;
+        return MLX_CMD_COMPLETE;
+    }
+    }
+
+    p->state = ST_IDLE;
+    return MLX_CMD_OUTSIDE;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * 串口二进制命令通道
+ *
+ * 命令只从控制台 UART 的输入方向进来（main.c 的 console_poll）。USB Serial/JTAG
+ * 口归 mlx_usbout 发帧用，不读它的 RX；确认日志同样走控制台 UART，所以 mlx_cmd.py
+ * 要连 UART 桥接的那个口，而不是看帧的 ttyACM 口。
+ *
+ * 帧格式：
+ *
+ *   0xA5 | id | len | payload[len] | crc8
+ *
+ * crc8 覆盖 id、len 和 payload（多项式 0x07，初值 0）。
+ * 帧外的字节被忽略，解析器遇到 0xA5 就重新开始，半帧或校验错的帧直接丢弃。
+ * 多字节字段均为小端。
+ */
+
+#define MLX_CMD_SYNC            0xA5
+#define MLX_CMD_MAX_PAYLOAD     8
+
+/* 命令 id 与载荷 */
+#define MLX_CMD_SET_REFRESH     0x01    // u8  0..7（0.5Hz ... 64Hz 子页速率）
+#define MLX_CMD_SET_RESOLUTION  0x02    // u8  0..3（16..19 bit ADC）
+#define MLX_CMD_SET_PATTERN     0x03    // u8  0 = interleaved，1 = chess
+#define MLX_CMD_SET_EMISSIVITY  0x04    // u16 单位 1/10000，范围 0.1..1.0
+#define MLX_CMD_SET_TR          0x05    // u8 模式（0 = Ta - TA_SHIFT，1 = 固定值）+ i16 单位 0.01°C
+#define MLX_CMD_SET_OUTPUT      0x06    // u8  见 main.c 的 OUTPUT_*
+#define MLX_CMD_GET_CONFIG      0x07    // 无载荷，打印当前配置
+#define MLX_CMD_SET_KEYFRAME    0x08    // u8  差分输出的关键帧间隔（帧），0/1 = 每帧关键帧
+#define MLX_CMD_PROFILE_DUMP    0x10
+#define MLX_CMD_PROFILE_RESET   0x11
+#define MLX_CMD_TRACE_DUMP      0x12    // 打印 I2C 事务追踪（需 MLX90640_I2C_TRACE）
+
+typedef struct {
+    uint8_t id;
+    uint8_t len;
+    uint8_t payload[MLX_CMD_MAX_PAYLOAD];
+} mlx_cmd_t;
+
+typedef struct {
+    uint8_t   state;
+    uint8_t   pos;
+    mlx_cmd_t cmd;
+    uint32_t  frames;
+    uint32_t  bad_crc;
+    uint32_t  bad_len;
+} mlx_cmd_parser_t;
+
+/* mlx_cmd_parse_byte 的返回值 */
+#define MLX_CMD_OUTSIDE     (-1)    // 帧外字节，可由调用方另行解释
+#define MLX_CMD_PENDING     0
+#define MLX_CMD_COMPLETE    1
+
+void mlx_cmd_parser_init(mlx_cmd_parser_t *p);
+int  mlx_cmd_parse_byte(mlx_cmd_parser_t *p, uint8_t b, mlx_cmd_t *out);
+
+uint8_t mlx_cmd_crc8(const uint8_t *data, size_t len);
+
+/* 编码一帧，返回长度（最多 MLX_CMD_MAX_PAYLOAD + 4） */
+size_t mlx_cmd_encode(const mlx_cmd_t *cmd, uint8_t *out);
+
+static inline uint16_t mlx_cmd_u16(const mlx_cmd_t *cmd, int off)
+{
+    return (uint16_t)(cmd->payload[off] | (cmd->payload[off + 1] << 8));
+}
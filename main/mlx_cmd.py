@@ -0,0 +1,115 @@
+"""
+MLX90640 运行时配置命令（帧格式见 mlx_cmd.h）
+
+命令走控制台 UART（USB 转串口桥，默认 /dev/ttyUSB0），不是 mlx_usbout 发帧的
+USB Serial/JTAG 口（ttyACM）。PORT 可以省略，省略时用 DEFAULT_PORT。
+
+  python mlx_cmd.py PORT refresh 5          # 0..7，0.5Hz ... 64Hz 子页速率
+  python mlx_cmd.py PORT resolution 2       # 0..3，16..19 bit
+  python mlx_cmd.py PORT pattern chess      # chess / interleaved
+  python mlx_cmd.py PORT emissivity 0.95
+  python mlx_cmd.py PORT tr auto            # Ta - TA_SHIFT
+  python mlx_cmd.py PORT tr 23.5            # 固定反射温度
+  python mlx_cmd.py PORT output csv         # text / csv / off / binary / delta / raw
+  python mlx_cmd.py PORT keyframe 32        # delta 输出的关键帧间隔
+  python mlx_cmd.py PORT config
+  python mlx_cmd.py PORT profile [reset]
+  python mlx_cmd.py PORT trace             # I2C 事务追踪直方图
+
+也可以 import 后对已打开的串口调用 send(ser, name, *args)。
+"""
+import struct
+import sys
+
+DEFAULT_PORT = "/dev/ttyUSB0"
+BAUD = 115200
+
+SYNC = 0xA5
+
+CMD_SET_REFRESH = 0x01
+CMD_SET_RESOLUTION = 0x02
+CMD_SET_PATTERN = 0x03
+CMD_SET_EMISSIVITY = 0x04
+CMD_SET_TR = 0x05
+CMD_SET_OUTPUT = 0x06
+CMD_GET_CONFIG = 0x07
+CMD_SET_KEYFRAME = 0x08
+CMD_PROFILE_DUMP = 0x10
+CMD_PROFILE_RESET = 0x11
+CMD_TRACE_DUMP = 0x12
+
+OUTPUT_FORMATS = {"text": 0, "csv": 1, "off": 2, "binary": 3, "delta": 4, "raw": 5}
+
+
+def crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def encode(cmd_id, payload=b""):
+    body = bytes([cmd_id, len(payload)]) + payload
+    return bytes([SYNC]) + body + bytes([crc8(body)])
+
+
+def build(name, *args):
+    """命令名 + 参数 → 一帧字节"""
+    if name == "refresh":
+        return encode(CMD_SET_REFRESH, bytes([int(args[0])]))
+    if name == "resolution":
+        return encode(CMD_SET_RESOLUTION, bytes([int(args[0])]))
+    if name == "pattern":
+        return encode(CMD_SET_PATTERN, bytes([1 if args[0] == "chess" else 0]))
+    if name == "emissivity":
+        return encode(CMD_SET_EMISSIVITY, struct.pack("<H", round(float(args[0]) * 10000)))
+    if name == "tr":
+        if args[0] == "auto":
+            return encode(CMD_SET_TR, struct.pack("<Bh", 0, 0))
+        return encode(CMD_SET_TR, struct.pack("<Bh", 1, round(float(args[0]) * 100)))
+    if name == "output":
+        return encode(CMD_SET_OUTPUT, bytes([OUTPUT_FORMATS[args[0]]]))
+    if name == "keyframe":
+        return encode(CMD_SET_KEYFRAME, bytes([int(args[0])]))
+    if name == "config":
+        return encode(CMD_GET_CONFIG)
+    if name == "profile":
+        return encode(CMD_PROFILE_RESET if args and args[0] == "reset" else CMD_PROFILE_DUMP)
+    if name == "trace":
+        return encode(CMD_TRACE_DUMP)
+    raise ValueError(f"unknown command: {name}")
+
+
+_COMMANDS = ("refresh", "resolution", "pattern", "emissivity", "tr", "output",
+             "keyframe", "config", "profile", "trace")
+
+
+def send(ser, name, *args):
+    ser.write(build(name, *args))
+    ser.flush()
+
+
+def main():
+    args = sys.argv[1:]
+    if args and args[0] in _COMMANDS:
+        args = [DEFAULT_PORT] + args
+    if len(args) < 2:
+        print(__doc__)
+        sys.exit(1)
+
+    import serial
+    ser = serial.Serial(args[0], BAUD, timeout=1)
+    send(ser, args[1], *args[2:])
+
+    # 回显设备的确认日志
+    for _ in range(5):
+        line = ser.readline().decode(errors="ignore").strip()
+        if "config:" in line or "rejected" in line:
+            print(line)
+            break
+
+
+if __name__ == "__main__":
+    main()
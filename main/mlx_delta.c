@@ -0,0 +1,91 @@
+#include "mlx_delta.h"
+
+#include <string.h>
+
+#include "mlx_proto.h"
+
+static inline uint32_t zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+/* 差分 zig-zag 后最大 17 bit，varint 最多 3 字节 */
+static inline int varint(uint32_t v, uint8_t *b)
+{
+    int n = 0;
+    while (v >= 0x80) {
+        b[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    b[n++] = (uint8_t)v;
+    return n;
+}
+
+static inline int varint_len(uint32_t v)
+{
+    return v < (1u << 7) ? 1 : v < (1u << 14) ? 2 : 3;
+}
+
+void mlx_delta_init(mlx_delta_enc_t *enc)
+{
+    memset(enc, 0, sizeof(*enc));
+}
+
+void mlx_delta_force_key(mlx_delta_enc_t *enc)
+{
+    enc->have_ref = false;
+}
+
+size_t mlx_delta_encode(mlx_delta_enc_t *enc, const mlx_frame_t *f, uint32_t key_interval, uint8_t *out)
+{
+    mlx_proto_writer_t w;
+    size_t payload = 0;
+
+    for (int i = 0; i < MLX90640_PIXEL_NUM; i++) {
+        enc->cur[i] = mlx_proto_centi(f->to[i]);
+        payload += varint_len(zigzag(enc->cur[i] - enc->prev[i]));
+    }
+
+    bool key = !enc->have_ref || f->seq != enc->prev_seq + 1 ||
+               enc->since_key + 1 >= key_interval ||
+               payload >= MLX90640_PIXEL_NUM * 2;
+
+    if (key) {
+        mlx_proto_begin(&w, out, MLX_PROTO_TYPE_FRAME);
+        mlx_proto_put_frame_header(&w, f);
+        for (int i = 0; i < MLX90640_PIXEL_NUM; i++) {
+            mlx_proto_put_u16(&w, (uint16_t)enc->cur[i]);
+        }
+        enc->since_key = 0;
+        __atomic_fetch_add(&enc->stats.keyframes, 1, __ATOMIC_RELAXED);
+    } else {
+        mlx_proto_begin(&w, out, MLX_PROTO_TYPE_FRAME_DELTA);
+        mlx_proto_put_frame_header(&w, f);
+        for (int i = 0; i < MLX90640_PIXEL_NUM; i++) {
+            uint8_t b[3];
+            mlx_proto_put(&w, b, varint(zigzag(enc->cur[i] - enc->prev[i]), b));
+        }
+        enc->since_key++;
+    }
+    size_t len = mlx_proto_end(&w);
+    size_t coded = key ? MLX_PROTO_FRAME_SIZE : MLX_PROTO_FRAME_HDR + payload + 4;
+
+    memcpy(enc->prev, enc->cur, sizeof(enc->prev));
+    enc->prev_seq = f->seq;
+    enc->have_ref = true;
+
+    /* 统计由 stream_report 在采集任务（另一个核）上读出清零 */
+    __atomic_fetch_add(&enc->stats.frames, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&enc->stats.raw_bytes, (uint64_t)MLX_PROTO_FRAME_SIZE, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&enc->stats.coded_bytes, (uint64_t)coded, __ATOMIC_RELAXED);
+    return len;
+}
+
+/* 与 mlx_usbout_get_stats 相同：各字段分别原子清零，边界上的一帧可能分到相邻两个窗口 */
+void mlx_delta_get_stats(mlx_delta_enc_t *enc, mlx_delta_stats_t *stats)
+{
+    stats->frames = __atomic_exchange_n(&enc->stats.frames, 0, __ATOMIC_RELAXED);
+    stats->keyframes = __atomic_exchange_n(&enc->stats.keyframes, 0, __ATOMIC_RELAXED);
+    stats->raw_bytes = __atomic_exchange_n(&enc->stats.raw_bytes, 0, __ATOMIC_RELAXED);
+    stats->coded_bytes = __atomic_exchange_n(&enc->stats.coded_bytes, 0, __ATOMIC_RELAXED);
+}
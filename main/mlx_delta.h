@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "mlx_frame.h"
+
+/*
+ * 时域差分压缩（线上格式见 mlx_proto.h 的 FRAME_DELTA）
+ *
+ * 相邻帧大部分像素只差噪声量级（几十个 0.01°C），zig-zag 后多为 1 字节 varint，
+ * 约为原始 i16 的一半。每 key_interval 帧发一次完整 FRAME 作为关键帧；
+ * 以下情况也强制关键帧，保证主机总能从最近的关键帧恢复：
+ *   - seq 不连续（采集端队列丢帧）
+ *   - 上一个包没发出去（mlx_delta_force_key）
+ *   - 差分编码比原始帧还大（场景突变）
+ *
+ * 编码器只在输出任务里使用，不加锁；统计计数是原子的，mlx_delta_get_stats 可以在别的任务上调用。
+ */
+
+#define MLX_DELTA_DEFAULT_KEY_INTERVAL  32
+
+typedef struct {
+    uint32_t frames;
+    uint32_t keyframes;
+    uint64_t raw_bytes;         // 全部按 FRAME 发送时的 packet 字节数（COBS 之前）
+    uint64_t coded_bytes;       // 实际 packet 字节数
+} mlx_delta_stats_t;
+
+typedef struct {
+    int16_t  prev[MLX90640_PIXEL_NUM];
+    int16_t  cur[MLX90640_PIXEL_NUM];
+    uint32_t prev_seq;
+    bool     have_ref;
+    uint32_t since_key;
+    mlx_delta_stats_t stats;
+} mlx_delta_enc_t;
+
+void mlx_delta_init(mlx_delta_enc_t *enc);
+
+/*
+ * 编码一帧，key_interval 为 0 或 1 时每帧都是关键帧。
+ * out 至少 MLX_PROTO_WIRE_MAX(MLX_PROTO_FRAME_SIZE) 字节，返回线上长度。
+ */
+size_t mlx_delta_encode(mlx_delta_enc_t *enc, const mlx_frame_t *f, uint32_t key_interval, uint8_t *out);
+
+/* 上一个包被丢弃时调用，下一帧发关键帧 */
+void mlx_delta_force_key(mlx_delta_enc_t *enc);
+
+/* 读出并清零统计窗口（可在编码任务以外调用） */
+void mlx_delta_get_stats(mlx_delta_enc_t *enc, mlx_delta_stats_t *stats);
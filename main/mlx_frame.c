@@ -0,0 +1,73 @@
+#include "mlx_frame.h"
+#include "mlx_profile.h"
+
+#include <string.h>
+
+void mlx_frame_assembler_init(mlx_frame_assembler_t *fa, paramsMLX90640 *params,
+                              float emissivity, float ta_shift)
+{
+    memset(fa, 0, sizeof(*fa));
+    fa->params = params;
+    fa->emissivity = emissivity;
+    fa->ta_shift = ta_shift;
+    fa->last_subpage = -1;
+}
+
+void mlx_frame_assembler_reset(mlx_frame_assembler_t *fa)
+{
+    fa->last_subpage = -1;
+    fa->have_mask = 0;
+}
+
+bool mlx_frame_assembler_push(mlx_frame_assembler_t *fa, uint16_t *frameData,
+                              int64_t t_us, mlx_frame_t *out)
+{
+    int subpage = MLX90640_GetSubPageNumber(frameData) & 0x1;
+
+    int64_t tp = mlx_profile_now();
+    float ta = MLX90640_GetTa(frameData, fa->params);
+    float vdd = MLX90640_GetVdd(frameData, fa->params);
+    int64_t tc = mlx_profile_now();
+    float tr = fa->tr_fixed ? fa->tr : ta - fa->ta_shift;
+    MLX90640_CalculateTo(frameData, fa->params, fa->emissivity, tr, fa->work);
+    mlx_profile_record(MLX_PROF_TA_VDD, tc - tp);
+    mlx_profile_record(MLX_PROF_CALC, mlx_profile_now() - tc);
+
+    if (fa->on_half) {
+        fa->on_half(fa->work, subpage, t_us, fa->on_half_ctx);
+    }
+
+    /* 只接受与上一个子页相反的子页，否则从当前子页重新开始 */
+    if (fa->last_subpage == !subpage && fa->have_mask != 0) {
+        fa->have_mask |= 1 << subpage;
+    } else {
+        if (fa->have_mask != 0) {
+            fa->restarts++;
+        }
+        fa->have_mask = 1 << subpage;
+        fa->t_first_us = t_us;
+    }
+    fa->last_subpage = subpage;
+
+    if (fa->have_mask != 0x3) {
+        return false;
+    }
+    fa->have_mask = 0;
+
+    out->seq = fa->seq++;
+    out->t_first_us = fa->t_first_us;
+    out->t_last_us = t_us;
+    out->ta = ta;
+    out->vdd = vdd;
+    out->ctrl = frameData[832];
+    out->subpage = (uint8_t)subpage;
+    memcpy(out->to, fa->work, sizeof(out->to));
+
+    tp = mlx_profile_now();
+    int mode = (frameData[832] & MLX90640_CTRL_MEAS_MODE_MASK) >> MLX90640_CTRL_MEAS_MODE_SHIFT;
+    MLX90640_BadPixelsCorrection(fa->params->brokenPixels, out->to, mode, fa->params);
+    MLX90640_BadPixelsCorrection(fa->params->outlierPixels, out->to, mode, fa->params);
+    mlx_profile_record(MLX_PROF_BADPIX, mlx_profile_now() - tp);
+
+    return true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "MLX90640_API.h"
+
+/*
+ * 整帧拼接
+ *
+ * MLX90640_CalculateTo 每次只更新一个子页（chess/interleaved 的一半像素）。
+ * 拼接器按 frameData[833] 跟踪子页号，只有相邻两个子页 0/1 都到齐时才输出
+ * 完整的 768 点温度帧，并附带序号和时间戳。
+ * 注册 on_half 回调可以在每个子页到达时立刻拿到半更新的温度图（低延迟用）。
+ */
+
+typedef struct {
+    uint32_t seq;
+    int64_t  t_first_us;        // 第一个子页读完的时间
+    int64_t  t_last_us;         // 第二个子页读完的时间
+    float    ta;
+    float    vdd;
+    uint16_t ctrl;              // 第二个子页的控制寄存器 frameData[832]
+    uint8_t  subpage;           // 第二个子页的子页号
+    float    to[MLX90640_PIXEL_NUM];
+} mlx_frame_t;
+
+/* 原始子页（raw 输出模式下整块交给主机标定） */
+#define MLX_RAW_WORDS   834         // 768 像素 + 64 aux + 控制寄存器 + 子页号
+
+typedef struct {
+    uint32_t seq;               // 子页序号
+    int64_t  t_us;              // 读完的时间
+    uint16_t words[MLX_RAW_WORDS];
+} mlx_raw_frame_t;
+
+typedef void (*mlx_frame_half_cb_t)(const float *to, int subpage, int64_t t_us, void *ctx);
+
+typedef struct {
+    paramsMLX90640 *params;
+    float    emissivity;
+    float    ta_shift;          // 反射温度 tr = Ta - ta_shift
+    bool     tr_fixed;          // true 时改用固定反射温度 tr
+    float    tr;
+
+    mlx_frame_half_cb_t on_half;
+    void    *on_half_ctx;
+
+    float    work[MLX90640_PIXEL_NUM];
+    int      last_subpage;      // -1 表示没有可衔接的子页
+    uint8_t  have_mask;         // bit0/bit1 = 子页 0/1 已到
+    int64_t  t_first_us;
+    uint32_t seq;
+    uint32_t restarts;          // 子页不连续导致重新拼接的次数
+} mlx_frame_assembler_t;
+
+void mlx_frame_assembler_init(mlx_frame_assembler_t *fa, paramsMLX90640 *params,
+                              float emissivity, float ta_shift);
+void mlx_frame_assembler_reset(mlx_frame_assembler_t *fa);
+
+/* 输入一个 GetFrameData 读到的子页；凑齐一整帧时写入 out 并返回 true */
+bool mlx_frame_assembler_push(mlx_frame_assembler_t *fa, uint16_t *frameData,
+                              int64_t t_us, mlx_frame_t *out);
@@ -0,0 +1,211 @@
+"""
+固件标定算法的 Python 绑定（ctypes 调用 MLX90640_API.c 编出的共享库）
+
+  gcc -O2 -shared -fPIC -Imain -Ihost main/MLX90640_API.c main/mlx_frame.c main/mlx_proto.c \\
+      host/mlx90640_host.c host/mlx90640_lib.c -lm -o host/libmlx90640.so
+
+  cal = Calibration(ee)                       # 832 个 EEPROM 字（CALIB 包 / 录制文件头）
+  to = cal.calculate_to(raw)                  # 单个子页，就地更新 result
+  frames = cal.convert(raw_array, threads=4)  # (N, 834) 原始子页 → (M, 24, 32) 整帧
+
+库的位置：环境变量 MLX90640_LIB，否则找 host/libmlx90640.so。
+ctypes 调用期间释放 GIL，convert 按帧分块交给线程池并行计算；
+结果与固件 / rec_convert 逐位相同。
+"""
+import ctypes
+import os
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+
+from mlx_proto import COLS, ROWS, RAW_WORDS, EE_WORDS
+
+PIXELS = ROWS * COLS
+TA_SHIFT = 8.0
+EMISSIVITY = 0.95
+
+
+def _ptr(ctype):
+    return np.ctypeslib.ndpointer(ctype, flags="C_CONTIGUOUS")
+
+
+def _load(path=None):
+    here = os.path.dirname(os.path.abspath(__file__))
+    candidates = [path, os.environ.get("MLX90640_LIB"),
+                  os.path.join(here, "..", "host", "libmlx90640.so"), "libmlx90640.so"]
+    errors = []
+    for p in filter(None, candidates):
+        try:
+            lib = ctypes.CDLL(p)
+            break
+        except OSError as e:
+            errors.append(str(e))
+    else:
+        raise OSError("libmlx90640.so not found (build it as shown in mlx_native.py or set MLX90640_LIB): "
+                      + "; ".join(errors))
+
+    u16, u32, u64, f32, u8 = (_ptr(np.uint16), _ptr(np.uint32), _ptr(np.uint64),
+                              _ptr(np.float32), _ptr(np.uint8))
+    c_float, c_int, c_size = ctypes.c_float, ctypes.c_int, ctypes.c_size_t
+    sigs = {
+        "mlx_lib_params_size": (c_size, []),
+        "MLX90640_ExtractParameters": (c_int, [u16, u8]),
+        "MLX90640_GetTa": (c_float, [u16, u8]),
+        "MLX90640_GetVdd": (c_float, [u16, u8]),
+        "MLX90640_GetImage": (None, [u16, u8, f32]),
+        "MLX90640_CalculateTo": (None, [u16, u8, c_float, c_float, f32]),
+        "mlx_lib_bad_pixels": (None, [u8, f32, c_int]),
+        "mlx_lib_pair": (c_size, [u16, ctypes.c_void_p, c_size, u64]),
+        "mlx_lib_convert": (c_size, [ctypes.c_void_p, ctypes.c_void_p, c_size, u8, c_float, c_float,
+                                     c_int, c_float, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p]),
+    }
+    for name, (res, args) in sigs.items():
+        fn = getattr(lib, name)
+        fn.restype, fn.argtypes = res, args
+    return lib
+
+
+_lib = None
+
+
+def lib():
+    global _lib
+    if _lib is None:
+        _lib = _load()
+    return _lib
+
+
+def _words(a, n, what):
+    a = np.ascontiguousarray(a, dtype=np.uint16)
+    if a.shape[-1] != n:
+        raise ValueError(f"{what}: expected {n} words, got shape {a.shape}")
+    return a
+
+
+class Calibration:
+    """一份 EEPROM 镜像解析出的 paramsMLX90640，之后只读，可多线程共用"""
+
+    def __init__(self, ee, emissivity=EMISSIVITY, ta_shift=TA_SHIFT, tr=None):
+        self.lib = lib()
+        self.params = np.zeros(self.lib.mlx_lib_params_size(), dtype=np.uint8)
+        # ExtractParameters 的参数不是 const，传副本
+        ret = self.lib.MLX90640_ExtractParameters(_words(ee, EE_WORDS, "ee").copy(), self.params)
+        if ret != 0:
+            raise ValueError(f"MLX90640_ExtractParameters failed ({ret})")
+        self.emissivity = emissivity
+        self.ta_shift = ta_shift
+        self.tr = tr                    # None：tr = Ta - ta_shift
+
+    # ================= 单个子页 =================
+    def ta(self, raw):
+        return self.lib.MLX90640_GetTa(_words(raw, RAW_WORDS, "raw"), self.params)
+
+    def vdd(self, raw):
+        return self.lib.MLX90640_GetVdd(_words(raw, RAW_WORDS, "raw"), self.params)
+
+    def _result(self, result):
+        if result is None:
+            return np.full(PIXELS, np.nan, dtype=np.float32)
+        if result.dtype != np.float32 or result.size != PIXELS or not result.flags.c_contiguous:
+            raise ValueError("result must be a contiguous float32 array of 768")
+        return result
+
+    def calculate_to(self, raw, result=None, emissivity=None, tr=None):
+        """只更新 raw 所在子页的像素；传入上一次的 result 即得到拼好的整帧"""
+        raw = _words(raw, RAW_WORDS, "raw")
+        result = self._result(result)
+        if tr is None:
+            tr = self.tr if self.tr is not None else self.ta(raw) - self.ta_shift
+        self.lib.MLX90640_CalculateTo(raw, self.params, self.emissivity if emissivity is None else emissivity,
+                                      tr, result.reshape(-1))
+        return result
+
+    def get_image(self, raw, result=None):
+        raw = _words(raw, RAW_WORDS, "raw")
+        result = self._result(result)
+        self.lib.MLX90640_GetImage(raw, self.params, result.reshape(-1))
+        return result
+
+    def bad_pixels_correction(self, to, mode):
+        """就地修正坏点 / 异常点，mode 为控制寄存器 bit 12（0 = interleaved，1 = chess）"""
+        if to.dtype != np.float32 or to.size != PIXELS or not to.flags.c_contiguous:
+            raise ValueError("to must be a contiguous float32 array of 768")
+        self.lib.mlx_lib_bad_pixels(self.params, to.reshape(-1), int(mode))
+        return to
+
+    # ================= 批量 =================
+    def pair(self, raw, seq=None):
+        """(N, 834) 子页配对，返回每帧第二个子页的下标"""
+        raw = _words(raw, RAW_WORDS, "raw").reshape(-1, RAW_WORDS)
+        n = len(raw)
+        second = np.empty(n // 2 + 1, dtype=np.uint64)
+        seq_p = None
+        if seq is not None:
+            seq = np.ascontiguousarray(seq, dtype=np.uint32)
+            if seq.shape != (n,):
+                raise ValueError("seq must have one entry per subpage")
+            seq_p = seq.ctypes.data
+        m = self.lib.mlx_lib_pair(raw, seq_p, n, second)
+        return second[:m]
+
+    def convert(self, raw, seq=None, threads=1, chunk=256):
+        """
+        原始子页 → 整帧温度，与固件的拼帧 + 坏点修正完全相同。
+        返回 (to (M, 24, 32) float32, ta (M,), vdd (M,), second (M,))，
+        second 为每帧第二个子页在 raw 中的下标（取时间戳、序号用）。
+        """
+        raw = _words(raw, RAW_WORDS, "raw").reshape(-1, RAW_WORDS)
+        second = self.pair(raw, seq)
+        m = len(second)
+        to = np.empty((m, ROWS, COLS), dtype=np.float32)
+        ta = np.empty(m, dtype=np.float32)
+        vdd = np.empty(m, dtype=np.float32)
+        tr_fixed = self.tr is not None
+
+        def run(a):
+            b = min(a + chunk, m)
+            # 各块写各自的输出区间，共享只读的 raw / params
+            return self.lib.mlx_lib_convert(
+                raw.ctypes.data, second[a:].ctypes.data, b - a, self.params,
+                self.emissivity, self.ta_shift, tr_fixed, self.tr or 0.0,
+                to[a:].ctypes.data, ta[a:].ctypes.data, vdd[a:].ctypes.data)
+
+        starts = range(0, m, chunk)
+        if threads > 1 and m > chunk:
+            with ThreadPoolExecutor(threads) as pool:
+                failed = sum(pool.map(run, starts))
+        else:
+            failed = sum(map(run, starts))
+        if failed:
+            raise RuntimeError(f"{failed} frames failed to assemble")
+        return to, ta, vdd, second
+
+
+if __name__ == "__main__":
+    # python mlx_native.py session.rec [out.npz] [-j N]    RAW 录制文件 → 温度
+    import argparse
+    import time
+
+    import mlx_rec
+
+    ap = argparse.ArgumentParser(description="Convert a raw recording with the native calibration library")
+    ap.add_argument("recording")
+    ap.add_argument("output", nargs="?")
+    ap.add_argument("-j", "--threads", type=int, default=os.cpu_count())
+    args = ap.parse_args()
+
+    rec = mlx_rec.Recording(args.recording)
+    if "raw" not in rec.records.dtype.names or not len(rec.ee):
+        raise SystemExit(f"{args.recording}: no raw subpages or calibration data")
+    h = rec.header
+    cal = Calibration(rec.ee, emissivity=rec.emissivity, ta_shift=h["ta_shift"] / 100.0,
+                      tr=h["tr"] / 100.0 if h["tr_fixed"] else None)
+
+    t0 = time.perf_counter()
+    to, ta, vdd, second = cal.convert(rec.records["raw"], rec.records["seq"], threads=args.threads)
+    dt = time.perf_counter() - t0
+    print(f"{len(rec)} subpages -> {len(to)} frames in {dt:.3f} s, {len(to) / dt:.0f} frames/s "
+          f"({args.threads} threads)")
+    if args.output:
+        np.savez(args.output, to=to, ta=ta, vdd=vdd,
+                 t_us=rec.records["t_us"][second], seq=rec.records["seq"][second])
@@ -0,0 +1,18 @@
+#pragma once
+
+/*
+ * 内存放置策略
+ *
+ *   热代码   main/linker.lf 映射到 IRAM（CONFIG_MLX_IRAM_KERNELS）
+ *   热数据   普通静态变量，IDF 默认放在内部 DRAM，不要加 MLX_COLD_BSS
+ *   冷数据   MLX_COLD_BSS：开启 CONFIG_SPIRAM_ALLOW_BSS_SEG_EXTERNAL_MEMORY 时
+ *            放到 PSRAM，否则与普通 .bss 相同
+ *
+ * 主机构建时这些宏为空。
+ */
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#define MLX_COLD_BSS    EXT_RAM_BSS_ATTR
+#else
+#define MLX_COLD_BSS
+#endif
@@ -0,0 +1,125 @@
+#include "mlx_pool.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "mlx_frame.h"
+#include "mlx_placement.h"
+
+#define POOL_TOTAL  (MLX_POOL_RAW_COUNT + MLX_POOL_TEMP_COUNT + MLX_POOL_RENDER_COUNT)
+
+_Static_assert(MLX_POOL_RAW_COUNT <= 32 && MLX_POOL_TEMP_COUNT <= 32 && MLX_POOL_RENDER_COUNT <= 32,
+               "pool classes are tracked in a 32-bit free mask");
+
+/* ===== 静态存储：原始帧和温度帧在热路径上，留在内部 DRAM ===== */
+static mlx_raw_frame_t raw_store[MLX_POOL_RAW_COUNT];
+static mlx_frame_t temp_store[MLX_POOL_TEMP_COUNT];
+static MLX_COLD_BSS uint8_t render_store[MLX_POOL_RENDER_COUNT][MLX_POOL_RENDER_SIZE];
+
+typedef struct {
+    mlx_buf_t *bufs;
+    uint32_t   count;
+    uint32_t   free_mask;       // bit = 1 表示空闲
+    uint32_t   in_use;
+    uint32_t   high_water;
+    uint32_t   alloc_fail;
+} pool_class_t;
+
+static mlx_buf_t bufs[POOL_TOTAL];
+static pool_class_t classes[MLX_POOL_CLASSES];
+
+static const char *const class_names[MLX_POOL_CLASSES] = { "raw", "temp", "render" };
+
+/* ================= 初始化 ================= */
+static void class_init(mlx_pool_class_t cls, mlx_buf_t *first, uint32_t count,
+                       void *store, size_t size)
+{
+    pool_class_t *c = &classes[cls];
+
+    c->bufs = first;
+    c->count = count;
+    c->free_mask = (count == 32) ? UINT32_MAX : ((1u << count) - 1);
+    c->in_use = 0;
+    c->high_water = 0;
+    c->alloc_fail = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        first[i].cls = (uint8_t)cls;
+        first[i].index = (uint8_t)i;
+        first[i].refs = 0;
+        first[i].data = (uint8_t *)store + i * size;
+        first[i].size = size;
+    }
+}
+
+void mlx_pool_init(void)
+{
+    class_init(MLX_POOL_RAW, &bufs[0], MLX_POOL_RAW_COUNT,
+               raw_store, sizeof(raw_store[0]));
+    class_init(MLX_POOL_TEMP, &bufs[MLX_POOL_RAW_COUNT], MLX_POOL_TEMP_COUNT,
+               temp_store, sizeof(temp_store[0]));
+    class_init(MLX_POOL_RENDER, &bufs[MLX_POOL_RAW_COUNT + MLX_POOL_TEMP_COUNT], MLX_POOL_RENDER_COUNT,
+               render_store, sizeof(render_store[0]));
+}
+
+/* ================= 分配 / 释放 ================= */
+mlx_buf_t *mlx_pool_alloc(mlx_pool_class_t cls)
+{
+    pool_class_t *c = &classes[cls];
+    uint32_t mask = __atomic_load_n(&c->free_mask, __ATOMIC_ACQUIRE);
+
+    while (mask) {
+        uint32_t i = (uint32_t)__builtin_ctz(mask);
+        if (__atomic_compare_exchange_n(&c->free_mask, &mask, mask & ~(1u << i), false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            mlx_buf_t *buf = &c->bufs[i];
+            __atomic_store_n(&buf->refs, 1, __ATOMIC_RELAXED);
+
+            uint32_t used = __atomic_add_fetch(&c->in_use, 1, __ATOMIC_RELAXED);
+            uint32_t hw = __atomic_load_n(&c->high_water, __ATOMIC_RELAXED);
+            while (used > hw &&
+                   !__atomic_compare_exchange_n(&c->high_water, &hw, used, false,
+                                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            }
+            return buf;
+        }
+    }
+
+    __atomic_fetch_add(&c->alloc_fail, 1, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+void mlx_buf_ref(mlx_buf_t *buf)
+{
+    __atomic_fetch_add(&buf->refs, 1, __ATOMIC_RELAXED);
+}
+
+void mlx_buf_unref(mlx_buf_t *buf)
+{
+    if (buf == NULL) {
+        return;
+    }
+    if (__atomic_sub_fetch(&buf->refs, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+
+    pool_class_t *c = &classes[buf->cls];
+    __atomic_fetch_sub(&c->in_use, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_or(&c->free_mask, 1u << buf->index, __ATOMIC_RELEASE);
+}
+
+/* ================= 统计 ================= */
+void mlx_pool_get_stats(mlx_pool_class_t cls, mlx_pool_stats_t *stats)
+{
+    const pool_class_t *c = &classes[cls];
+
+    stats->capacity = c->count;
+    stats->in_use = __atomic_load_n(&c->in_use, __ATOMIC_RELAXED);
+    stats->high_water = __atomic_load_n(&c->high_water, __ATOMIC_RELAXED);
+    stats->alloc_fail = __atomic_load_n(&c->alloc_fail, __ATOMIC_RELAXED);
+}
+
+const char *mlx_pool_class_name(mlx_pool_class_t cls)
+{
+    return class_names[cls];
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * 静态帧缓冲池
+ *
+ * 原始帧、温度帧、输出缓冲都从固定容量的静态池里分配，稳态下不走堆。
+ * 缓冲带引用计数，可以在流水线各阶段之间只传指针：
+ * 谁需要继续持有就 mlx_buf_ref，用完 mlx_buf_unref，计数归零自动回池。
+ * 分配和释放都是无锁的，可以跨核调用。
+ */
+
+#define MLX_POOL_RAW_COUNT      6       // mlx_raw_frame_t：raw 输出时同样要队列深度 + 2
+#define MLX_POOL_TEMP_COUNT     6       // mlx_frame_t：队列深度 + 采集端 1 + 输出端 1
+#define MLX_POOL_RENDER_COUNT   2
+#define MLX_POOL_RENDER_SIZE    2048    // 编码 / 格式化输出
+
+typedef enum {
+    MLX_POOL_RAW = 0,
+    MLX_POOL_TEMP,
+    MLX_POOL_RENDER,
+    MLX_POOL_CLASSES
+} mlx_pool_class_t;
+
+typedef struct {
+    uint8_t  cls;
+    uint8_t  index;
+    uint16_t refs;
+    void    *data;
+    size_t   size;
+} mlx_buf_t;
+
+typedef struct {
+    uint32_t capacity;
+    uint32_t in_use;
+    uint32_t high_water;
+    uint32_t alloc_fail;
+} mlx_pool_stats_t;
+
+void mlx_pool_init(void);
+
+/* 返回引用计数为 1 的缓冲，池空时返回 NULL */
+mlx_buf_t *mlx_pool_alloc(mlx_pool_class_t cls);
+void mlx_buf_ref(mlx_buf_t *buf);
+void mlx_buf_unref(mlx_buf_t *buf);
+
+void mlx_pool_get_stats(mlx_pool_class_t cls, mlx_pool_stats_t *stats);
+const char *mlx_pool_class_name(mlx_pool_class_t cls);
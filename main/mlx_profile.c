@@ -0,0 +1,137 @@
+#include "mlx_profile.h"
+
+#if MLX_PROFILE
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#include "esp_log.h"
+#define TAG "MLX_PROFILE"
+#define PROFILE_LOG(fmt, ...)   ESP_LOGI(TAG, fmt, ##__VA_ARGS__)
+#else
+#include <time.h>
+#define PROFILE_LOG(fmt, ...)   printf(fmt "\n", ##__VA_ARGS__)
+#endif
+
+#define SUB_BITS        2
+#define SUB_BUCKETS     (1 << SUB_BITS)
+#define HIST_BUCKETS    (SUB_BUCKETS * 24)      // 覆盖到 2^24 us ≈ 16 s
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t hist[HIST_BUCKETS];
+} stage_hist_t;
+
+/* 每个阶段只由一个任务写入，Dump 时读到的是近似快照 */
+static stage_hist_t stages[MLX_PROF_STAGES];
+
+static const char *const stage_names[MLX_PROF_STAGES] = {
+    "wait", "pixel", "aux", "ta_vdd", "calc", "badpix", "encode", "output"
+};
+
+int64_t mlx_profile_now(void)
+{
+#ifdef ESP_PLATFORM
+    return esp_timer_get_time();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+/* ================= 直方图 ================= */
+
+/* 0..3 各占一档，之后每个 2 倍区间按次高两位再分 4 档 */
+static int bucket_of(uint32_t us)
+{
+    if (us < SUB_BUCKETS) {
+        return (int)us;
+    }
+    int msb = 31 - __builtin_clz(us);
+    int b = SUB_BUCKETS * (msb - SUB_BITS + 1) + (int)((us >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1));
+    return b < HIST_BUCKETS ? b : HIST_BUCKETS - 1;
+}
+
+static uint32_t bucket_upper(int b)
+{
+    if (b < SUB_BUCKETS) {
+        return (uint32_t)b;
+    }
+    int shift = b / SUB_BUCKETS - 1;
+    uint32_t sub = (uint32_t)(b % SUB_BUCKETS);
+    return ((SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+static uint32_t percentile(const stage_hist_t *h, uint32_t permille)
+{
+    uint32_t rank = (uint32_t)(((uint64_t)h->count * permille + 999) / 1000);
+    uint32_t seen = 0;
+
+    for (int b = 0; b < HIST_BUCKETS; b++) {
+        seen += h->hist[b];
+        if (seen >= rank) {
+            uint32_t v = bucket_upper(b);
+            return v < h->max_us ? v : h->max_us;
+        }
+    }
+    return h->max_us;
+}
+
+/* ================= 记录 ================= */
+void mlx_profile_record(mlx_prof_stage_t stage, int64_t us)
+{
+    stage_hist_t *h = &stages[stage];
+    uint32_t v = us < 0 ? 0 : (us > UINT32_MAX ? UINT32_MAX : (uint32_t)us);
+
+    if (h->count == 0 || v < h->min_us) h->min_us = v;
+    if (v > h->max_us) h->max_us = v;
+    h->sum_us += v;
+    h->hist[bucket_of(v)]++;
+    h->count++;
+}
+
+void mlx_profile_reset(void)
+{
+    memset(stages, 0, sizeof(stages));
+}
+
+void mlx_profile_get(mlx_prof_stage_t stage, mlx_prof_summary_t *out)
+{
+    const stage_hist_t *h = &stages[stage];
+
+    memset(out, 0, sizeof(*out));
+    if (h->count == 0) {
+        return;
+    }
+    out->count   = h->count;
+    out->min_us  = h->min_us;
+    out->mean_us = (uint32_t)(h->sum_us / h->count);
+    out->p50_us  = percentile(h, 500);
+    out->p99_us  = percentile(h, 990);
+    out->max_us  = h->max_us;
+}
+
+/* ================= 输出 ================= */
+void mlx_profile_dump(void)
+{
+    PROFILE_LOG("stage        n      min     mean      p50      p99      max (us)");
+
+    for (int i = 0; i < MLX_PROF_STAGES; i++) {
+        mlx_prof_summary_t s;
+        mlx_profile_get(i, &s);
+        if (s.count == 0) {
+            continue;
+        }
+        PROFILE_LOG("%-7s %7" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32,
+                    stage_names[i], s.count, s.min_us, s.mean_us, s.p50_us, s.p99_us, s.max_us);
+    }
+}
+
+#endif
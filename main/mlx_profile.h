@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * 流水线分阶段耗时统计
+ *
+ * 每个阶段记录 min / mean / max 和一个对数直方图（每个 2 倍区间分 4 档，
+ * 相对误差 < 25%），据此给出 p50 / p99。
+ * MLX_PROFILE 为 0 时 mlx_profile_now() 恒为 0、record 为空，
+ * 调用处的计时代码会被编译器整体消掉，可以留在量产代码里。
+ *
+ * 固件在 menuconfig 里打开（CONFIG_MLX_PROFILE，见 Kconfig.projbuild），
+ * 主机程序用 -DMLX_PROFILE=1 构建。
+ */
+#ifndef MLX_PROFILE
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+#ifdef CONFIG_MLX_PROFILE
+#define MLX_PROFILE 1
+#else
+#define MLX_PROFILE 0
+#endif
+#endif
+
+typedef enum {
+    MLX_PROF_WAIT = 0,      // 轮询 data-ready
+    MLX_PROF_PIXEL,         // 读像素 RAM
+    MLX_PROF_AUX,           // 读 aux + 控制寄存器
+    MLX_PROF_TA_VDD,
+    MLX_PROF_CALC,          // MLX90640_CalculateTo
+    MLX_PROF_BADPIX,        // MLX90640_BadPixelsCorrection
+    MLX_PROF_ENCODE,        // 输出格式化
+    MLX_PROF_OUTPUT,        // 写串口
+    MLX_PROF_STAGES
+} mlx_prof_stage_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t mean_us;
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} mlx_prof_summary_t;
+
+#if MLX_PROFILE
+
+int64_t mlx_profile_now(void);
+void mlx_profile_record(mlx_prof_stage_t stage, int64_t us);
+void mlx_profile_get(mlx_prof_stage_t stage, mlx_prof_summary_t *out);
+void mlx_profile_dump(void);
+void mlx_profile_reset(void);
+
+#else
+
+static inline int64_t mlx_profile_now(void) { return 0; }
+static inline void mlx_profile_record(mlx_prof_stage_t stage, int64_t us) { (void)stage; (void)us; }
+static inline void mlx_profile_dump(void) { }
+static inline void mlx_profile_reset(void) { }
+
+#endif
@@ -0,0 +1,226 @@
+#include "mlx_proto.h"
+
+#include <math.h>
+#include <string.h>
+
+/* ================= CRC32 ================= */
+
+/* 半字节查表，表只有 64 字节，速度约为逐位算法的 4 倍 */
+static const uint32_t crc_nibble[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+uint32_t mlx_proto_crc32(uint32_t crc, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= p[i];
+        crc = (crc >> 4) ^ crc_nibble[crc & 0xF];
+        crc = (crc >> 4) ^ crc_nibble[crc & 0xF];
+    }
+    return ~crc;
+}
+
+/* ================= COBS 写入 ================= */
+static void cobs_byte(mlx_proto_writer_t *w, uint8_t b)
+{
+    if (b != 0) {
+        w->out[w->pos++] = b;
+        w->code++;
+    }
+    if (b == 0 || w->code == 0xFF) {
+        w->out[w->code_pos] = w->code;
+        w->code_pos = w->pos++;
+        w->code = 1;
+    }
+}
+
+void mlx_proto_begin(mlx_proto_writer_t *w, uint8_t *out, uint8_t type)
+{
+    w->out = out;
+    w->out[0] = 0x00;
+    w->code_pos = 1;
+    w->pos = 2;
+    w->code = 1;
+    w->crc = 0;
+
+    mlx_proto_put_u8(w, MLX_PROTO_VERSION);
+    mlx_proto_put_u8(w, type);
+}
+
+void mlx_proto_put(mlx_proto_writer_t *w, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+
+    w->crc = mlx_proto_crc32(w->crc, p, len);
+    for (size_t i = 0; i < len; i++) {
+        cobs_byte(w, p[i]);
+    }
+}
+
+void mlx_proto_put_u8(mlx_proto_writer_t *w, uint8_t v)
+{
+    mlx_proto_put(w, &v, 1);
+}
+
+void mlx_proto_put_u16(mlx_proto_writer_t *w, uint16_t v)
+{
+    uint8_t b[2] = { (uint8_t)v, (uint8_t)(v >> 8) };
+    mlx_proto_put(w, b, 2);
+}
+
+void mlx_proto_put_u32(mlx_proto_writer_t *w, uint32_t v)
+{
+    mlx_proto_put_u16(w, (uint16_t)v);
+    mlx_proto_put_u16(w, (uint16_t)(v >> 16));
+}
+
+void mlx_proto_put_u64(mlx_proto_writer_t *w, uint64_t v)
+{
+    mlx_proto_put_u32(w, (uint32_t)v);
+    mlx_proto_put_u32(w, (uint32_t)(v >> 32));
+}
+
+size_t mlx_proto_end(mlx_proto_writer_t *w)
+{
+    uint32_t crc = w->crc;
+    uint8_t b[4] = { (uint8_t)crc, (uint8_t)(crc >> 8), (uint8_t)(crc >> 16), (uint8_t)(crc >> 24) };
+
+    for (int i = 0; i < 4; i++) {
+        cobs_byte(w, b[i]);
+    }
+    w->out[w->code_pos] = w->code;
+    w->out[w->pos++] = 0x00;
+    return w->pos;
+}
+
+/* ================= 温度帧 ================= */
+int16_t mlx_proto_centi(float v)
+{
+    float c = v * 100.0f;
+    if (!(c > -32768.0f)) {
+        return INT16_MIN;       // 含 NaN
+    }
+    if (c > 32767.0f) {
+        return INT16_MAX;
+    }
+    return (int16_t)lrintf(c);
+}
+
+void mlx_proto_put_frame_header(mlx_proto_writer_t *w, const mlx_frame_t *f)
+{
+    mlx_proto_put_u32(w, f->seq);
+    mlx_proto_put_u64(w, (uint64_t)f->t_last_us);
+    mlx_proto_put_u16(w, (uint16_t)mlx_proto_centi(f->ta));
+    mlx_proto_put_u16(w, (uint16_t)lrintf(f->vdd * 1000.0f));
+    mlx_proto_put_u16(w, f->ctrl);
+    mlx_proto_put_u8(w, f->subpage);
+    mlx_proto_put_u8(w, 0);
+}
+
+size_t mlx_proto_encode_frame(const mlx_frame_t *f, uint8_t *out)
+{
+    mlx_proto_writer_t w;
+
+    mlx_proto_begin(&w, out, MLX_PROTO_TYPE_FRAME);
+    mlx_proto_put_frame_header(&w, f);
+    for (int i = 0; i < MLX90640_PIXEL_NUM; i++) {
+        mlx_proto_put_u16(&w, (uint16_t)mlx_proto_centi(f->to[i]));
+    }
+    return mlx_proto_end(&w);
+}
+
+/* ================= 原始子页 / 标定 ================= */
+static void put_words(mlx_proto_writer_t *w, const uint16_t *words, int n)
+{
+    for (int i = 0; i < n; i++) {
+        mlx_proto_put_u16(w, words[i]);
+    }
+}
+
+size_t mlx_proto_encode_raw(const mlx_raw_frame_t *rf, uint8_t *out)
+{
+    mlx_proto_writer_t w;
+
+    mlx_proto_begin(&w, out, MLX_PROTO_TYPE_RAW);
+    mlx_proto_put_u32(&w, rf->seq);
+    mlx_proto_put_u64(&w, (uint64_t)rf->t_us);
+    put_words(&w, rf->words, MLX_RAW_WORDS);
+    return mlx_proto_end(&w);
+}
+
+size_t mlx_proto_encode_calib(const uint16_t *eeData, uint8_t *out)
+{
+    mlx_proto_writer_t w;
+
+    mlx_proto_begin(&w, out, MLX_PROTO_TYPE_CALIB);
+    put_words(&w, eeData, MLX90640_EEPROM_DUMP_NUM);
+    return mlx_proto_end(&w);
+}
+
+/* ================= 资源监控 ================= */
+size_t mlx_proto_encode_metrics(const mlx_sysmon_record_t *rec, uint8_t *out)
+{
+    mlx_proto_writer_t w;
+    uint8_t n = rec->ntasks < MLX_SYSMON_MAX_TASKS ? rec->ntasks : MLX_SYSMON_MAX_TASKS;
+
+    mlx_proto_begin(&w, out, MLX_PROTO_TYPE_METRICS);
+    mlx_proto_put_u32(&w, rec->uptime_ms);
+    mlx_proto_put_u8(&w, rec->cpu_pct[0]);
+    mlx_proto_put_u8(&w, rec->cpu_pct[1]);
+    mlx_proto_put_u8(&w, n);
+    mlx_proto_put_u8(&w, 0);
+    mlx_proto_put_u32(&w, rec->heap_free);
+    mlx_proto_put_u32(&w, rec->heap_min_free);
+    mlx_proto_put_u32(&w, rec->heap_largest);
+    mlx_proto_put_u32(&w, rec->psram_free);
+    for (int i = 0; i < n; i++) {
+        const mlx_sysmon_task_t *t = &rec->tasks[i];
+        char name[MLX_SYSMON_NAME_LEN] = { 0 };
+        memcpy(name, t->name, strnlen(t->name, MLX_SYSMON_NAME_LEN - 1));
+        mlx_proto_put(&w, name, MLX_SYSMON_NAME_LEN);
+        mlx_proto_put_u8(&w, t->core);
+        mlx_proto_put_u8(&w, t->cpu_pct);
+        mlx_proto_put_u16(&w, t->stack_free);
+    }
+    return mlx_proto_end(&w);
+}
+
+/* ================= 解码 ================= */
+int mlx_proto_decode(const uint8_t *in, size_t len, uint8_t *out, size_t cap)
+{
+    size_t n = 0;
+    size_t i = 0;
+
+    while (i < len) {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > len) {
+            return -1;
+        }
+        for (int k = 1; k < code; k++) {
+            if (n >= cap) {
+                return -1;
+            }
+            out[n++] = in[i++];
+        }
+        if (code != 0xFF && i < len) {
+            if (n >= cap) {
+                return -1;
+            }
+            out[n++] = 0;
+        }
+    }
+
+    if (n < 2 + 4 || out[0] != MLX_PROTO_VERSION) {
+        return -1;
+    }
+    n -= 4;
+    uint32_t crc = out[n] | (out[n + 1] << 8) | (out[n + 2] << 16) | ((uint32_t)out[n + 3] << 24);
+    if (mlx_proto_crc32(0, out, n) != crc) {
+        return -1;
+    }
+    return (int)n;
+}
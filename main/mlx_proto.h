@@ -0,0 +1,114 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "mlx_frame.h"
+#include "mlx_sysmon.h"
+
+/*
+ * 串口二进制帧协议
+ *
+ * 线上格式：0x00 | COBS(packet) | 0x00
+ * 前导 0x00 把混在同一串口上的日志文本和包隔开，主机按 0x00 切分后
+ * 逐段 COBS 解码、校验 CRC，失败的段直接丢弃即可重新同步。
+ *
+ * packet（小端）：
+ *   u8  version         MLX_PROTO_VERSION
+ *   u8  type            MLX_PROTO_TYPE_*
+ *   ...                 各类型的载荷
+ *   u32 crc32           IEEE 802.3，覆盖 version 到载荷末尾
+ *
+ * MLX_PROTO_TYPE_FRAME 载荷：
+ *   u32 seq
+ *   u64 t_us            第二个子页读完的时间
+ *   i16 ta              0.01°C
+ *   u16 vdd             mV
+ *   u16 ctrl            控制寄存器
+ *   u8  subpage         第二个子页的子页号
+ *   u8  reserved
+ *   i16 to[768]         0.01°C，行优先 24x32
+ *
+ * MLX_PROTO_TYPE_FRAME_DELTA 载荷（mlx_delta.h）：
+ *   与 FRAME 相同的 20 字节帧头
+ *   varint d[768]       zig-zag 编码的 to[i] - 上一帧 to[i]（0.01°C）
+ *
+ * 差分帧只能接在 seq 连续的上一帧之后解码；FRAME 同时充当关键帧，
+ * 主机丢包或序号不连续时丢弃差分帧，直到下一个 FRAME。
+ *
+ * MLX_PROTO_TYPE_RAW 载荷（温度在主机端计算，见 host/mlx90640_host.h）：
+ *   u32 seq             子页序号
+ *   u64 t_us            子页读完的时间
+ *   u16 frame[834]      GetFrameData 的原始输出
+ *
+ * MLX_PROTO_TYPE_CALIB 载荷：
+ *   u16 ee[832]         EEPROM 镜像，主机用 MLX90640_ExtractParameters 解析
+ *
+ * MLX_PROTO_TYPE_METRICS 载荷（mlx_sysmon_record_t，与帧走同一个口）：
+ *   u32 uptime_ms
+ *   u8  cpu_pct[2]
+ *   u8  ntasks          不超过 MLX_SYSMON_MAX_TASKS
+ *   u8  reserved
+ *   u32 heap_free, heap_min_free, heap_largest, psram_free
+ *   每个任务 16 字节：char name[12]（0 填充）| u8 core | u8 cpu_pct | u16 stack_free
+ */
+
+#define MLX_PROTO_VERSION       1
+
+#define MLX_PROTO_TYPE_FRAME    0x01
+#define MLX_PROTO_TYPE_FRAME_DELTA 0x02
+#define MLX_PROTO_TYPE_RAW      0x03
+#define MLX_PROTO_TYPE_CALIB    0x04
+#define MLX_PROTO_TYPE_METRICS  0x05
+
+#define MLX_PROTO_FRAME_HDR     22      // version 到 reserved
+#define MLX_PROTO_FRAME_SIZE    (MLX_PROTO_FRAME_HDR + MLX90640_PIXEL_NUM * 2 + 4)
+#define MLX_PROTO_RAW_SIZE      (2 + 12 + MLX_RAW_WORDS * 2 + 4)
+#define MLX_PROTO_CALIB_SIZE    (2 + MLX90640_EEPROM_DUMP_NUM * 2 + 4)
+#define MLX_PROTO_METRICS_HDR   26      // version 到 psram_free
+#define MLX_PROTO_METRICS_TASK  (MLX_SYSMON_NAME_LEN + 4)
+#define MLX_PROTO_METRICS_MAX   (MLX_PROTO_METRICS_HDR + MLX_SYSMON_MAX_TASKS * MLX_PROTO_METRICS_TASK + 4)
+
+/* n 字节 packet 编码后在线上的最大长度（含前后两个 0x00） */
+#define MLX_PROTO_WIRE_MAX(n)   ((n) + (n) / 254 + 1 + 2)
+
+/* 边写边做 COBS 编码和 CRC，不需要中间缓冲 */
+typedef struct {
+    uint8_t *out;
+    size_t   pos;
+    size_t   code_pos;          // 当前 COBS 块长度字节的位置
+    uint8_t  code;
+    uint32_t crc;
+} mlx_proto_writer_t;
+
+void   mlx_proto_begin(mlx_proto_writer_t *w, uint8_t *out, uint8_t type);
+void   mlx_proto_put(mlx_proto_writer_t *w, const void *data, size_t len);
+void   mlx_proto_put_u8(mlx_proto_writer_t *w, uint8_t v);
+void   mlx_proto_put_u16(mlx_proto_writer_t *w, uint16_t v);
+void   mlx_proto_put_u32(mlx_proto_writer_t *w, uint32_t v);
+void   mlx_proto_put_u64(mlx_proto_writer_t *w, uint64_t v);
+size_t mlx_proto_end(mlx_proto_writer_t *w);   // 返回线上总长度
+
+/* 温度帧编码，out 至少 MLX_PROTO_WIRE_MAX(MLX_PROTO_FRAME_SIZE) 字节 */
+size_t mlx_proto_encode_frame(const mlx_frame_t *f, uint8_t *out);
+
+/* 原始子页 / EEPROM 标定包，out 至少 MLX_PROTO_WIRE_MAX(MLX_PROTO_RAW_SIZE) 字节 */
+size_t mlx_proto_encode_raw(const mlx_raw_frame_t *rf, uint8_t *out);
+size_t mlx_proto_encode_calib(const uint16_t *eeData, uint8_t *out);
+
+/* 资源监控记录，out 至少 MLX_PROTO_WIRE_MAX(MLX_PROTO_METRICS_MAX) 字节 */
+size_t mlx_proto_encode_metrics(const mlx_sysmon_record_t *rec, uint8_t *out);
+
+/* seq 到 reserved 的帧头，FRAME 与 FRAME_DELTA 共用 */
+void   mlx_proto_put_frame_header(mlx_proto_writer_t *w, const mlx_frame_t *f);
+
+/* °C → 0.01°C，饱和到 int16，NaN 记为 INT16_MIN */
+int16_t mlx_proto_centi(float v);
+
+/*
+ * 解码一段不含 0x00 的 COBS 数据并校验 CRC。
+ * 成功返回去掉 CRC 后的 packet 长度（从 version 开始），失败返回 -1。
+ */
+int    mlx_proto_decode(const uint8_t *in, size_t len, uint8_t *out, size_t cap);
+
+uint32_t mlx_proto_crc32(uint32_t crc, const void *data, size_t len);
@@ -0,0 +1,244 @@
+"""
+MLX90640 二进制帧协议的主机端解码（格式见 mlx_proto.h）
+
+  for frame in iter_frames(ser):       # 任何有 read(n) 的对象
+      print(frame.seq, frame.ta, frame.to.max())
+
+解码只依赖 numpy；串口上混杂的日志文本会被当成坏包丢弃。
+差分帧（output delta）由 FrameDecoder 还原，iter_frames 已自动处理。
+设备资源监控（METRICS 包）用 parse_metrics 解出 Metrics。
+"""
+import struct
+import zlib
+from dataclasses import dataclass
+
+import numpy as np
+
+VERSION = 1
+TYPE_FRAME = 0x01
+TYPE_FRAME_DELTA = 0x02
+TYPE_RAW = 0x03
+TYPE_CALIB = 0x04
+TYPE_METRICS = 0x05
+
+ROWS, COLS = 24, 32
+FRAME_HDR = struct.Struct("<BBIQhHHBB")     # 22 字节
+FRAME_SIZE = FRAME_HDR.size + ROWS * COLS * 2
+RAW_HDR = struct.Struct("<BBIQ")            # 14 字节
+RAW_WORDS = 834
+RAW_SIZE = RAW_HDR.size + RAW_WORDS * 2
+EE_WORDS = 832
+METRICS_HDR = struct.Struct("<BBIBBBBIIII")  # 26 字节
+METRICS_TASK = struct.Struct("<12sBBH")     # 16 字节
+METRICS_MAX_TASKS = 16
+NO_CORE = 0xFF
+
+
+@dataclass
+class Frame:
+    seq: int
+    t_us: int
+    ta: float
+    vdd: float
+    ctrl: int
+    subpage: int
+    to: np.ndarray      # (24, 32) float32，°C
+
+
+@dataclass
+class Metrics:
+    """设备资源监控（mlx_sysmon.h）；tasks 为 (名字, 核 或 None, cpu%, 最低剩余栈字节)"""
+    uptime_ms: int
+    cpu_pct: tuple
+    heap_free: int
+    heap_min_free: int
+    heap_largest: int
+    psram_free: int
+    tasks: list
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def decode_packet(chunk):
+    """一段不含 0x00 的线上数据 → (type, payload)；坏包返回 None"""
+    raw = cobs_decode(chunk)
+    if raw is None or len(raw) < 6 or raw[0] != VERSION:
+        return None
+    body, crc = raw[:-4], struct.unpack("<I", raw[-4:])[0]
+    if zlib.crc32(body) != crc:
+        return None
+    return body[1], body
+
+
+def _make_frame(body, centi):
+    _, _, seq, t_us, ta, vdd, ctrl, subpage, _ = FRAME_HDR.unpack_from(body)
+    to = centi.astype(np.float32) / 100.0
+    return Frame(seq, t_us, ta / 100.0, vdd / 1000.0, ctrl, subpage, to.reshape(ROWS, COLS))
+
+
+def parse_frame(body):
+    if len(body) != FRAME_SIZE:
+        return None
+    return _make_frame(body, np.frombuffer(body, dtype="<i2", offset=FRAME_HDR.size))
+
+
+def parse_raw(body):
+    """RAW 包 → (seq, t_us, uint16[834])，温度需在主机端标定（host/mlx90640_host.h）"""
+    if len(body) != RAW_SIZE:
+        return None
+    _, _, seq, t_us = RAW_HDR.unpack_from(body)
+    return seq, t_us, np.frombuffer(body, dtype="<u2", offset=RAW_HDR.size)
+
+
+def parse_calib(body):
+    """CALIB 包 → uint16[832] EEPROM 镜像"""
+    if len(body) != 2 + EE_WORDS * 2:
+        return None
+    return np.frombuffer(body, dtype="<u2", offset=2)
+
+
+def parse_metrics(body):
+    """METRICS 包 → Metrics，长度不符返回 None"""
+    if len(body) < METRICS_HDR.size:
+        return None
+    _, _, uptime, cpu0, cpu1, n, _, heap, heap_min, largest, psram = METRICS_HDR.unpack_from(body)
+    if n > METRICS_MAX_TASKS or len(body) != METRICS_HDR.size + n * METRICS_TASK.size:
+        return None
+    tasks = []
+    for i in range(n):
+        name, core, cpu, stack = METRICS_TASK.unpack_from(body, METRICS_HDR.size + i * METRICS_TASK.size)
+        tasks.append((name.split(b"\0", 1)[0].decode(errors="replace"),
+                      None if core == NO_CORE else core, cpu, stack))
+    return Metrics(uptime, (cpu0, cpu1), heap, heap_min, largest, psram, tasks)
+
+
+def decode_varints(data, count):
+    """zig-zag varint 串 → int32 数组（向量化，不逐字节循环）；个数不符返回 None"""
+    b = np.frombuffer(data, dtype=np.uint8)
+    ends = np.flatnonzero(b < 0x80)
+    if len(ends) != count or ends[-1] != len(b) - 1:
+        return None
+    starts = np.concatenate(([0], ends[:-1] + 1))
+    group = np.repeat(np.arange(count), ends - starts + 1)
+    shift = 7 * (np.arange(len(b)) - starts[group])
+    weights = (b & 0x7F).astype(np.int64) << shift
+    v = np.bincount(group, weights=weights, minlength=count).astype(np.int64)
+    return ((v >> 1) ^ -(v & 1)).astype(np.int32)
+
+
+class FrameDecoder:
+    """FRAME / FRAME_DELTA → Frame；差分帧需要 seq 连续的参考帧，否则丢弃直到下一个关键帧"""
+
+    def __init__(self):
+        self.ref = None
+        self.ref_seq = None
+        self.skipped = 0
+
+    def decode(self, ptype, body):
+        if ptype == TYPE_FRAME and len(body) == FRAME_SIZE:
+            centi = np.frombuffer(body, dtype="<i2", offset=FRAME_HDR.size).astype(np.int32)
+        elif ptype == TYPE_FRAME_DELTA and len(body) > FRAME_HDR.size:
+            seq = FRAME_HDR.unpack_from(body)[2]
+            delta = None
+            if self.ref is not None and seq == (self.ref_seq + 1) & 0xFFFFFFFF:
+                delta = decode_varints(body[FRAME_HDR.size:], ROWS * COLS)
+            if delta is None:
+                self.ref = None
+                self.skipped += 1
+                return None
+            centi = self.ref + delta
+        else:
+            return None
+        self.ref = centi
+        self.ref_seq = FRAME_HDR.unpack_from(body)[2]
+        return _make_frame(body, centi)
+
+
+class PacketSplitter:
+    """按 0x00 切分字节流，逐个返回解码成功的 (type, payload)"""
+
+    def __init__(self, max_len=8192):
+        self.buf = bytearray()
+        self.max_len = max_len
+        self.bad = 0
+
+    def feed(self, data):
+        self.buf += data
+        packets = []
+        while True:
+            end = self.buf.find(b"\x00")
+            if end < 0:
+                if len(self.buf) > self.max_len:
+                    self.buf.clear()    # 长时间没有分隔符：丢掉重新同步
+                break
+            chunk = bytes(self.buf[:end])
+            del self.buf[:end + 1]
+            if not chunk:
+                continue
+            pkt = decode_packet(chunk)
+            if pkt is None:
+                self.bad += 1
+            else:
+                packets.append(pkt)
+        return packets
+
+
+def iter_frames(stream, read_size=4096):
+    splitter = PacketSplitter()
+    decoder = FrameDecoder()
+    while True:
+        data = stream.read(read_size)
+        if not data:
+            continue
+        for ptype, body in splitter.feed(data):
+            frame = decoder.decode(ptype, body)
+            if frame is not None:
+                yield frame
+
+
+def measure(stream, seconds=5.0, read_size=16384):
+    """吞吐测量：每 seconds 秒打印一次帧率、字节率、序号缺口、坏包与无法还原的差分帧数"""
+    import time
+
+    splitter = PacketSplitter()
+    decoder = FrameDecoder()
+    frames = nbytes = gaps = 0
+    last_seq = None
+    t0 = time.monotonic()
+    while True:
+        data = stream.read(read_size)
+        nbytes += len(data)
+        for ptype, body in splitter.feed(data):
+            frame = decoder.decode(ptype, body)
+            if frame is None:
+                continue
+            if last_seq is not None and frame.seq != (last_seq + 1) & 0xFFFFFFFF:
+                gaps += (frame.seq - last_seq - 1) & 0xFFFFFFFF
+            last_seq = frame.seq
+            frames += 1
+        dt = time.monotonic() - t0
+        if dt >= seconds:
+            print(f"{frames / dt:6.1f} frames/s  {nbytes / 1024 / dt:7.1f} KB/s  "
+                  f"lost={gaps}  bad={splitter.bad}  skipped={decoder.skipped}")
+            frames = nbytes = gaps = 0
+            splitter.bad = decoder.skipped = 0
+            t0 += dt
+
+
+if __name__ == "__main__":
+    # python mlx_proto.py /dev/ttyACM0    （USB Serial/JTAG 忽略波特率）
+    import sys
+    import serial
+    measure(serial.Serial(sys.argv[1], 115200, timeout=0.1))
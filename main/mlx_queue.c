@@ -0,0 +1,74 @@
+#include "mlx_queue.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define READY_MASK  (MLX_QUEUE_DEPTH - 1)
+
+_Static_assert((MLX_QUEUE_DEPTH & READY_MASK) == 0,
+               "MLX_QUEUE_DEPTH must be a power of two");
+
+void mlx_queue_init(mlx_queue_t *q)
+{
+    memset(q, 0, sizeof(*q));
+}
+
+/* ================= 就绪环 ================= */
+
+/* 消费者调用；与 publish 的挤出共用 CAS，保证每一项只被取走一次 */
+static void *ready_pop(mlx_queue_t *q)
+{
+    uint32_t tail = __atomic_load_n(&q->ready_tail, __ATOMIC_ACQUIRE);
+
+    while (1) {
+        uint32_t head = __atomic_load_n(&q->ready_head, __ATOMIC_ACQUIRE);
+        if (tail == head) {
+            return NULL;
+        }
+        void *item = q->ready[tail & READY_MASK];
+        if (__atomic_compare_exchange_n(&q->ready_tail, &tail, tail + 1, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            return item;
+        }
+        /* 失败时 tail 已被更新为最新值，重试 */
+    }
+}
+
+/* ================= 生产者 ================= */
+void *mlx_queue_publish(mlx_queue_t *q, void *item)
+{
+    uint32_t head = q->ready_head;
+    uint32_t tail = __atomic_load_n(&q->ready_tail, __ATOMIC_ACQUIRE);
+    void *oldest = NULL;
+
+    if (head - tail >= MLX_QUEUE_DEPTH) {
+        /*
+         * 满：丢弃最旧的一项。只试一次 CAS，不能用 ready_pop 重试：
+         * 失败说明消费者刚取走一项，已经不满，重试会再挤掉一项
+         */
+        void *victim = q->ready[tail & READY_MASK];
+        if (__atomic_compare_exchange_n(&q->ready_tail, &tail, tail + 1, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            oldest = victim;
+            __atomic_fetch_add(&q->drops, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    q->ready[head & READY_MASK] = item;
+    __atomic_store_n(&q->ready_head, head + 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&q->published, 1, __ATOMIC_RELAXED);
+    return oldest;
+}
+
+/* ================= 消费者 ================= */
+void *mlx_queue_take(mlx_queue_t *q)
+{
+    return ready_pop(q);
+}
+
+uint32_t mlx_queue_count(const mlx_queue_t *q)
+{
+    return __atomic_load_n(&q->ready_head, __ATOMIC_ACQUIRE)
+         - __atomic_load_n(&q->ready_tail, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * 单生产者 / 单消费者无锁队列，满时丢弃最旧的一项
+ *
+ * 队列只传递指针，数据由调用方管理（通常是 mlx_pool 的缓冲），全程零拷贝：
+ *
+ *   生产者：dropped = mlx_queue_publish(item)，dropped 非空时由生产者释放
+ *   消费者：item = mlx_queue_take() → 用完后自行释放
+ *
+ * 就绪环满时 publish 用 CAS 从消费者手里抢走最旧的一项返回给生产者，
+ * 并计入 drops；消费端永远不会阻塞生产端。
+ */
+
+#define MLX_QUEUE_DEPTH     4   // 就绪环长度，必须是 2 的幂
+
+typedef struct {
+    /* 就绪环：生产者写 head，tail 由双方 CAS 推进 */
+    void     *ready[MLX_QUEUE_DEPTH];
+    uint32_t  ready_head;
+    uint32_t  ready_tail;
+
+    uint32_t  published;
+    uint32_t  drops;
+} mlx_queue_t;
+
+void  mlx_queue_init(mlx_queue_t *q);
+
+/* 返回因队列满被挤掉的最旧一项，没有则返回 NULL */
+void *mlx_queue_publish(mlx_queue_t *q, void *item);
+
+void *mlx_queue_take(mlx_queue_t *q);
+
+uint32_t mlx_queue_count(const mlx_queue_t *q);
@@ -0,0 +1,155 @@
+#include "mlx_rec.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "mlx_proto.h"
+
+uint32_t mlx_rec_record_size(uint16_t contents)
+{
+    uint32_t size = sizeof(mlx_rec_record_t);
+
+    if (contents & MLX_REC_RAW) {
+        size += MLX_RAW_WORDS * 2;
+    }
+    if (contents & MLX_REC_CENTI) {
+        size += MLX90640_PIXEL_NUM * 2;
+    }
+    return (size + MLX_REC_ALIGN - 1) & ~(uint32_t)(MLX_REC_ALIGN - 1);
+}
+
+uint16_t mlx_rec_header_size(uint16_t ee_words)
+{
+    return (uint16_t)((sizeof(mlx_rec_header_t) + ee_words * 2 + 15) & ~15u);
+}
+
+static const uint8_t zeros[MLX_REC_ALIGN];
+
+static int put(mlx_rec_writer_t *w, const void *data, size_t len)
+{
+    if (w->error) {
+        return -1;
+    }
+    if (w->write(data, len, w->ctx) != len) {
+        w->error = 1;
+        return -1;
+    }
+    w->offset += len;
+    return 0;
+}
+
+/* ================= 文件头 ================= */
+int mlx_rec_begin(mlx_rec_writer_t *w, const mlx_rec_config_t *cfg, const uint16_t *eeData,
+                  mlx_rec_index_t *index, uint32_t index_cap,
+                  mlx_rec_write_fn write, void *ctx)
+{
+    mlx_rec_header_t h;
+    uint16_t ee_words = eeData ? MLX90640_EEPROM_DUMP_NUM : 0;
+
+    memset(w, 0, sizeof(*w));
+    w->write = write;
+    w->ctx = ctx;
+    w->contents = cfg->contents;
+    w->record_size = mlx_rec_record_size(cfg->contents);
+    w->index = index;
+    w->index_cap = index_cap & ~1u;
+    w->stride = 1;
+
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MLX_REC_MAGIC, 4);
+    h.version = MLX_REC_VERSION;
+    h.header_size = mlx_rec_header_size(ee_words);
+    h.record_size = w->record_size;
+    h.contents = cfg->contents;
+    h.refresh_rate = cfg->refresh_rate;
+    h.resolution = cfg->resolution;
+    h.pattern = cfg->pattern;
+    h.tr_fixed = cfg->tr_fixed;
+    h.emissivity = (uint16_t)lrintf(cfg->emissivity * 10000.0f);
+    h.ta_shift = mlx_proto_centi(cfg->ta_shift);
+    h.tr = mlx_proto_centi(cfg->tr);
+    h.ee_words = ee_words;
+    h.start_unix_us = cfg->start_unix_us;
+
+    put(w, &h, sizeof(h));
+    if (eeData) {
+        put(w, eeData, ee_words * 2);
+    }
+    put(w, zeros, h.header_size - w->offset);
+    return w->error ? -1 : 0;
+}
+
+/* ================= 记录 ================= */
+
+/* 索引满了隔项保留，stride 翻倍 */
+static void index_add(mlx_rec_writer_t *w, int64_t t_us)
+{
+    if (w->index_cap == 0 || w->records % w->stride != 0) {
+        return;
+    }
+    if (w->index_len == w->index_cap) {
+        for (uint32_t i = 0; i < w->index_cap / 2; i++) {
+            w->index[i] = w->index[i * 2];
+        }
+        w->index_len = w->index_cap / 2;
+        w->stride *= 2;
+        if (w->records % w->stride != 0) {
+            return;
+        }
+    }
+    w->index[w->index_len].t_us = t_us;
+    w->index[w->index_len].record = w->records;
+    w->index_len++;
+}
+
+int mlx_rec_put(mlx_rec_writer_t *w, const mlx_raw_frame_t *raw, const mlx_frame_t *f)
+{
+    mlx_rec_record_t r;
+
+    if (((w->contents & MLX_REC_RAW) && raw == NULL) || ((w->contents & MLX_REC_CENTI) && f == NULL)) {
+        return -1;
+    }
+
+    r.seq = raw ? raw->seq : f->seq;
+    r.t_us = raw ? raw->t_us : f->t_last_us;
+    r.subpage = raw ? raw->words[833] : f->subpage;
+    r.ta = f ? mlx_proto_centi(f->ta) : MLX_REC_TA_UNKNOWN;
+
+    uint64_t start = w->offset;
+    index_add(w, r.t_us);
+    put(w, &r, sizeof(r));
+    if (w->contents & MLX_REC_RAW) {
+        put(w, raw->words, MLX_RAW_WORDS * 2);
+    }
+    if (w->contents & MLX_REC_CENTI) {
+        int16_t centi[64];
+        for (int i = 0; i < MLX90640_PIXEL_NUM; i += 64) {
+            for (int k = 0; k < 64; k++) {
+                centi[k] = mlx_proto_centi(f->to[i + k]);
+            }
+            put(w, centi, sizeof(centi));
+        }
+    }
+    if (!w->error) {
+        put(w, zeros, w->record_size - (size_t)(w->offset - start));
+    }
+    w->records++;
+    return w->error ? -1 : 0;
+}
+
+/* ================= 尾部 ================= */
+int mlx_rec_end(mlx_rec_writer_t *w)
+{
+    mlx_rec_footer_t ft;
+
+    memset(&ft, 0, sizeof(ft));
+    memcpy(ft.magic, MLX_REC_FOOTER_MAGIC, 4);
+    ft.entries = w->index_len;
+    ft.stride = w->stride;
+    ft.records = w->records;
+    ft.index_offset = w->offset;
+
+    put(w, w->index, (size_t)w->index_len * sizeof(mlx_rec_index_t));
+    put(w, &ft, sizeof(ft));
+    return w->error ? -1 : 0;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "mlx_frame.h"
+
+/*
+ * 录制文件格式（设备端与主机端共用，Python 侧见 mlx_rec.py）
+ *
+ *   文件头   mlx_rec_header_t + EEPROM 镜像（ee_words 个 u16），共 header_size 字节
+ *   记录区   定长记录 × N，第 i 条位于 header_size + i * record_size
+ *   尾部     索引 mlx_rec_index_t × entries + mlx_rec_footer_t（文件最后 32 字节）
+ *
+ * 全部小端、自然对齐，主机上可以整个 mmap 后按下标直接访问任意一帧。
+ * 写入是纯顺序的（不回写文件头），只需要 write 回调：
+ *   - 尾部缺失或校验不过（掉电、进程被杀）时，记录数按文件长度推算，
+ *     最后一条不完整的记录丢弃；
+ *   - 索引是稀疏的：每 stride 条记录一项，条目写满后隔项丢弃并把 stride 翻倍，
+ *     所以写端只需要固定大小的内存。记录本身带时间戳，读端在两项之间再二分。
+ *
+ * 记录 = mlx_rec_record_t 头 + 按 contents 出现的载荷 + 补零到 16 字节的倍数：
+ *   MLX_REC_RAW     u16 raw[834]    GetFrameData 的原始子页，主机端用 EEPROM 镜像标定
+ *   MLX_REC_CENTI   i16 to[768]     整帧温度，0.01°C
+ * 两者都有时 raw 在前。只有 RAW 时每条记录是一个子页，否则是一整帧。
+ * 补零保证每条记录的 int64 t_us 在 mmap 上 8 字节对齐（RAW 是 16 + 1668 = 1684 字节，
+ * 不补的话奇数条记录不对齐），索引和尾部也随之对齐。
+ */
+
+#define MLX_REC_MAGIC           "MLXR"
+#define MLX_REC_FOOTER_MAGIC    "MLXI"
+#define MLX_REC_VERSION         2       // 1：记录不补齐
+#define MLX_REC_ALIGN           16
+
+#define MLX_REC_RAW             0x0001
+#define MLX_REC_CENTI           0x0002
+
+#define MLX_REC_TA_UNKNOWN      INT16_MIN   // 只录 RAW 时没有 Ta
+
+typedef struct {
+    char     magic[4];
+    uint16_t version;
+    uint16_t header_size;       // 第一条记录的偏移，16 字节对齐
+    uint32_t record_size;       // MLX_REC_ALIGN 的倍数
+    uint16_t contents;          // MLX_REC_RAW | MLX_REC_CENTI
+    uint8_t  refresh_rate;      // 0..7
+    uint8_t  resolution;        // 0..3
+    uint8_t  pattern;           // 0 = interleaved，1 = chess
+    uint8_t  tr_fixed;          // 0 = tr 取 Ta - ta_shift，1 = 固定 tr
+    uint16_t emissivity;        // 1/10000
+    int16_t  ta_shift;          // 0.01°C
+    int16_t  tr;                // 0.01°C
+    uint16_t ee_words;          // 832，没有标定数据时为 0
+    uint16_t reserved0[3];
+    int64_t  start_unix_us;     // 录制开始的墙钟时间，未知为 0
+    uint8_t  reserved[8];
+} mlx_rec_header_t;
+
+typedef struct {
+    uint32_t seq;               // RAW：子页序号，否则整帧序号
+    uint16_t subpage;
+    int16_t  ta;                // 0.01°C
+    int64_t  t_us;              // 设备时间
+} mlx_rec_record_t;
+
+typedef struct {
+    int64_t  t_us;
+    uint64_t record;
+} mlx_rec_index_t;
+
+typedef struct {
+    char     magic[4];
+    uint32_t entries;
+    uint32_t stride;
+    uint32_t reserved;
+    uint64_t records;
+    uint64_t index_offset;
+} mlx_rec_footer_t;
+
+_Static_assert(sizeof(mlx_rec_header_t) == 48, "header layout");
+_Static_assert(sizeof(mlx_rec_record_t) == 16, "record layout");
+_Static_assert(sizeof(mlx_rec_index_t) == 16, "index layout");
+_Static_assert(sizeof(mlx_rec_footer_t) == 32, "footer layout");
+
+/* 录制参数，对应文件头里的传感器配置 */
+typedef struct {
+    uint16_t contents;
+    uint8_t  refresh_rate;
+    uint8_t  resolution;
+    uint8_t  pattern;
+    uint8_t  tr_fixed;
+    float    emissivity;
+    float    ta_shift;
+    float    tr;
+    int64_t  start_unix_us;
+} mlx_rec_config_t;
+
+/* 返回实际写入的字节数，小于 len 视为错误 */
+typedef size_t (*mlx_rec_write_fn)(const void *data, size_t len, void *ctx);
+
+typedef struct {
+    mlx_rec_write_fn write;
+    void    *ctx;
+    uint16_t contents;
+    uint32_t record_size;
+    uint64_t records;
+    uint64_t offset;            // 已写入的字节数
+
+    mlx_rec_index_t *index;     // 调用方提供的索引存储
+    uint32_t index_cap;         // 必须是偶数
+    uint32_t index_len;
+    uint32_t stride;
+
+    int      error;
+} mlx_rec_writer_t;
+
+uint32_t mlx_rec_record_size(uint16_t contents);
+uint16_t mlx_rec_header_size(uint16_t ee_words);
+
+/* eeData 可为 NULL（不带标定数据）。成功返回 0 */
+int mlx_rec_begin(mlx_rec_writer_t *w, const mlx_rec_config_t *cfg, const uint16_t *eeData,
+                  mlx_rec_index_t *index, uint32_t index_cap,
+                  mlx_rec_write_fn write, void *ctx);
+
+/*
+ * 写一条记录。contents 含 RAW 时 raw 不能为 NULL，含 CENTI 时 f 不能为 NULL；
+ * 序号、时间优先取 raw，其次取 f。
+ */
+int mlx_rec_put(mlx_rec_writer_t *w, const mlx_raw_frame_t *raw, const mlx_frame_t *f);
+
+/* 写索引和尾部，之后不能再 put */
+int mlx_rec_end(mlx_rec_writer_t *w);
@@ -0,0 +1,213 @@
+"""
+录制文件的主机端读写（格式定义见 mlx_rec.h）
+
+  rec = Recording("session.rec")          # 整个文件 mmap，打开不读数据
+  i = rec.seek(t_us)                      # 稀疏索引 + 二分，长录制也是即时定位
+  rec.records["t_us"][i], rec.temperatures(i)
+
+  with RecordingWriter("out.rec", ee=ee) as w:   # 录 mlx_receiver 收到的温度帧
+      for frame in rx:
+          w.write(frame)
+
+只录 RAW 的文件需要主机端标定才能得到温度（host/mlx90640_host.h、rec_capture）。
+"""
+import os
+
+import numpy as np
+
+from mlx_proto import COLS, ROWS, RAW_WORDS, EE_WORDS
+
+MAGIC = b"MLXR"
+FOOTER_MAGIC = b"MLXI"
+VERSION = 2
+ALIGN = 16
+
+RAW = 0x0001
+CENTI = 0x0002
+TA_UNKNOWN = -32768
+
+HEADER = np.dtype([
+    ("magic", "S4"), ("version", "<u2"), ("header_size", "<u2"), ("record_size", "<u4"),
+    ("contents", "<u2"), ("refresh_rate", "u1"), ("resolution", "u1"), ("pattern", "u1"),
+    ("tr_fixed", "u1"), ("emissivity", "<u2"), ("ta_shift", "<i2"), ("tr", "<i2"),
+    ("ee_words", "<u2"), ("reserved0", "<u2", 3), ("start_unix_us", "<i8"), ("reserved", "u1", 8),
+])
+INDEX = np.dtype([("t_us", "<i8"), ("record", "<u8")])
+FOOTER = np.dtype([
+    ("magic", "S4"), ("entries", "<u4"), ("stride", "<u4"), ("reserved", "<u4"),
+    ("records", "<u8"), ("index_offset", "<u8"),
+])
+assert HEADER.itemsize == 48 and INDEX.itemsize == 16 and FOOTER.itemsize == 32
+
+
+def record_dtype(contents):
+    """记录按 ALIGN 字节补齐，与 mlx_rec_record_size 一致"""
+    fields = [("seq", "<u4"), ("subpage", "<u2"), ("ta", "<i2"), ("t_us", "<i8")]
+    if contents & RAW:
+        fields.append(("raw", "<u2", (RAW_WORDS,)))
+    if contents & CENTI:
+        fields.append(("to", "<i2", (ROWS, COLS)))
+    packed = np.dtype(fields)
+    return np.dtype({"names": packed.names, "formats": [packed.fields[n][0] for n in packed.names],
+                     "offsets": [packed.fields[n][1] for n in packed.names],
+                     "itemsize": (packed.itemsize + ALIGN - 1) & ~(ALIGN - 1)})
+
+
+def header_size(ee_words):
+    return (HEADER.itemsize + ee_words * 2 + 15) & ~15
+
+
+class Recording:
+    """只读打开录制文件；records 是 mmap 上的结构化数组，下标访问不拷贝"""
+
+    def __init__(self, path):
+        self.mm = np.memmap(path, dtype=np.uint8, mode="r")
+        if len(self.mm) < HEADER.itemsize:
+            raise ValueError(f"{path}: not a recording")
+        self.header = self.mm[:HEADER.itemsize].view(HEADER)[0]
+        h = self.header
+        dtype = record_dtype(int(h["contents"]))
+        if (h["magic"] != MAGIC or h["version"] != VERSION or h["record_size"] != dtype.itemsize
+                or h["header_size"] < header_size(int(h["ee_words"]))):
+            raise ValueError(f"{path}: not a recording")
+
+        hs = int(h["header_size"])
+        self.ee = self.mm[HEADER.itemsize:HEADER.itemsize + int(h["ee_words"]) * 2].view("<u2")
+        self.index = None
+        self.stride = 0
+        self.truncated = True
+        count = (len(self.mm) - hs) // dtype.itemsize
+
+        # 尾部与文件长度吻合才采用，否则按录制中断处理
+        if len(self.mm) >= hs + FOOTER.itemsize and len(self.mm) % ALIGN == 0:
+            ft = self.mm[-FOOTER.itemsize:].view(FOOTER)[0]
+            end = hs + int(ft["records"]) * dtype.itemsize
+            if (ft["magic"] == FOOTER_MAGIC and ft["index_offset"] == end and ft["stride"] > 0
+                    and end + int(ft["entries"]) * INDEX.itemsize + FOOTER.itemsize == len(self.mm)):
+                count = int(ft["records"])
+                self.index = self.mm[end:end + int(ft["entries"]) * INDEX.itemsize].view(INDEX)
+                self.stride = int(ft["stride"])
+                self.truncated = False
+
+        self.records = self.mm[hs:hs + count * dtype.itemsize].view(dtype)
+
+    def __len__(self):
+        return len(self.records)
+
+    @property
+    def emissivity(self):
+        return self.header["emissivity"] / 10000.0
+
+    def seek(self, t_us):
+        """第一条 t_us >= t 的记录下标"""
+        lo, hi = 0, len(self.records)
+        if self.index is not None and len(self.index):
+            a = int(np.searchsorted(self.index["t_us"], t_us, side="left"))
+            if a > 0:
+                lo = int(self.index["record"][a - 1]) + 1
+            if a < len(self.index):
+                hi = int(self.index["record"][a])
+        # 只在两项索引之间的记录上二分，不会把整列时间戳读进内存
+        while lo < hi:
+            mid = (lo + hi) // 2
+            if self.records["t_us"][mid] < t_us:
+                lo = mid + 1
+            else:
+                hi = mid
+        return lo
+
+    def temperatures(self, i):
+        """第 i 条记录的温度图（°C），只有 RAW 的录制返回 None"""
+        if "to" not in self.records.dtype.names:
+            return None
+        return self.records["to"][i].astype(np.float32) / 100.0
+
+
+class RecordingWriter:
+    """顺序写入；index_cap 项写满后隔项丢弃、stride 翻倍，与设备端写法一致"""
+
+    def __init__(self, path, contents=CENTI, ee=None, refresh_rate=0, resolution=0, pattern=0,
+                 emissivity=0.95, ta_shift=8.0, tr=None, start_unix_us=0, index_cap=4096):
+        self.f = open(path, "wb")
+        self.contents = contents
+        self.dtype = record_dtype(contents)
+        self.records = 0
+        self.offset = 0
+        self.index = []
+        self.index_cap = index_cap & ~1
+        self.stride = 1
+
+        ee_words = EE_WORDS if ee is not None else 0
+        h = np.zeros((), HEADER)
+        h["magic"], h["version"] = MAGIC, VERSION
+        h["header_size"], h["record_size"] = header_size(ee_words), self.dtype.itemsize
+        h["contents"], h["refresh_rate"], h["resolution"], h["pattern"] = contents, refresh_rate, resolution, pattern
+        h["tr_fixed"], h["tr"] = tr is not None, round((tr or 0) * 100)
+        h["emissivity"], h["ta_shift"] = round(emissivity * 10000), round(ta_shift * 100)
+        h["ee_words"], h["start_unix_us"] = ee_words, start_unix_us
+        self._put(h.tobytes())
+        if ee is not None:
+            self._put(np.asarray(ee, dtype="<u2").tobytes())
+        self._put(bytes(int(h["header_size"]) - self.offset))
+
+    def _put(self, data):
+        self.f.write(data)
+        self.offset += len(data)
+
+    def _index_add(self, t_us):
+        if self.index_cap == 0 or self.records % self.stride:
+            return
+        if len(self.index) == self.index_cap:
+            self.index = self.index[::2]
+            self.stride *= 2
+            if self.records % self.stride:
+                return
+        self.index.append((t_us, self.records))
+
+    def write(self, frame=None, raw=None, seq=None, t_us=None, subpage=None):
+        """frame 为 mlx_proto.Frame（CENTI），raw 为 834 个 u16（RAW）"""
+        r = np.zeros((), self.dtype)
+        r["seq"] = seq if seq is not None else frame.seq
+        r["t_us"] = t_us if t_us is not None else frame.t_us
+        r["subpage"] = subpage if subpage is not None else (raw[833] if raw is not None else frame.subpage)
+        r["ta"] = TA_UNKNOWN if frame is None or np.isnan(frame.ta) else round(frame.ta * 100)
+        if self.contents & RAW:
+            r["raw"] = raw
+        if self.contents & CENTI:
+            to = np.nan_to_num(np.asarray(frame.to, dtype=np.float64) * 100, nan=TA_UNKNOWN)
+            r["to"] = np.clip(np.rint(to), -32768, 32767)
+        self._index_add(int(r["t_us"]))
+        self._put(r.tobytes())
+        self.records += 1
+
+    def close(self):
+        if self.f.closed:
+            return
+        index = np.array(self.index, dtype=INDEX)
+        ft = np.zeros((), FOOTER)
+        ft["magic"], ft["entries"], ft["stride"] = FOOTER_MAGIC, len(index), self.stride
+        ft["records"], ft["index_offset"] = self.records, self.offset
+        self._put(index.tobytes())
+        self._put(ft.tobytes())
+        self.f.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+if __name__ == "__main__":
+    # python mlx_rec.py session.rec    打印文件头和记录概况
+    import sys
+    rec = Recording(sys.argv[1])
+    h = rec.header
+    t = rec.records["t_us"]
+    kinds = "+".join(n for n, bit in (("raw", RAW), ("centi", CENTI)) if h["contents"] & bit)
+    print(f"{sys.argv[1]}: {len(rec)} {kinds} records, {os.path.getsize(sys.argv[1])} bytes"
+          f"{' (truncated, no index)' if rec.truncated else f', index {len(rec.index)} x stride {rec.stride}'}")
+    print(f"refresh={h['refresh_rate']} resolution={h['resolution']} pattern={'chess' if h['pattern'] else 'interleaved'}"
+          f" emissivity={rec.emissivity:.4f} calib={'yes' if len(rec.ee) else 'no'}")
+    if len(rec):
+        print(f"t = {t[0]} .. {t[-1]} us ({(t[-1] - t[0]) / 1e6:.1f} s)")
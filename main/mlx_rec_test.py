@@ -0,0 +1,147 @@
+"""
+录制格式的互通自检：C 写 → Python 读、Python 写 → C 读、尾部缺失的文件、索引隔项丢弃 + seek
+
+  python mlx_rec_test.py [rec_test 可执行文件]
+
+不给路径时用 cc 在临时目录里编译 host/rec_test.c（构建命令见该文件开头），
+环境变量 CFLAGS 可加 -fsanitize=undefined 等选项。全部通过返回 0。
+合成数据由记录下标决定，gen() 与 host/rec_test.c 的 gen 一一对应。
+"""
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+from types import SimpleNamespace
+
+import numpy as np
+
+import mlx_rec
+from mlx_proto import COLS, ROWS, RAW_WORDS, EE_WORDS
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCES = ["main/MLX90640_API.c", "main/mlx_frame.c", "main/mlx_proto.c", "main/mlx_rec.c",
+           "host/mlx90640_host.c", "host/mlx_rec_map.c", "host/rec_test.c"]
+
+N = 300             # 索引容量 16 时 stride 会翻倍到 32
+INDEX_CAP = 16
+CONTENTS = mlx_rec.RAW | mlx_rec.CENTI
+EE = np.arange(EE_WORDS, dtype=np.uint16) * 3 + 1
+
+failures = 0
+
+
+def check(cond, msg):
+    global failures
+    if not cond:
+        failures += 1
+        print("FAIL:", msg)
+
+
+def gen(i):
+    k = np.arange(RAW_WORDS, dtype=np.uint64)
+    raw = ((i * 31 + k * 7) & 0xFFFF).astype(np.uint16)
+    raw[833] = i & 1
+    p = np.arange(ROWS * COLS, dtype=np.int64)
+    centi = ((i * 17 + p * 3) % 20000 - 5000).astype(np.int16).reshape(ROWS, COLS)
+    return SimpleNamespace(seq=i, subpage=i & 1, t_us=1000 + i * 62500 + (i % 7) * 13,
+                           ta=((i % 3000) - 1000) / 100.0, raw=raw, centi=centi)
+
+
+def build(tmp):
+    exe = os.path.join(tmp, "rec_test")
+    cflags = os.environ.get("CFLAGS", "-O2 -Wall").split()
+    subprocess.run(["cc", *cflags, "-Imain", "-Ihost", *SOURCES, "-lm", "-o", exe], cwd=ROOT, check=True)
+    return exe
+
+
+def py_write(path, n):
+    with mlx_rec.RecordingWriter(path, contents=CONTENTS, ee=EE, refresh_rate=4, resolution=3,
+                                 pattern=1, emissivity=0.95, ta_shift=8.0, index_cap=INDEX_CAP) as w:
+        for i in range(n):
+            g = gen(i)
+            w.write(frame=SimpleNamespace(ta=g.ta, to=g.centi / 100.0), raw=g.raw,
+                    seq=g.seq, t_us=g.t_us, subpage=g.subpage)
+
+
+def py_check(path, n, truncated=False):
+    rec = mlx_rec.Recording(path)
+    r = rec.records
+    check(len(rec) == n, f"{path}: {len(rec)} records, expected {n}")
+    check(rec.truncated == truncated, f"{path}: truncated {rec.truncated}")
+    check(r.dtype.itemsize == rec.header["record_size"] and r.dtype.itemsize % mlx_rec.ALIGN == 0,
+          f"{path}: record size {r.dtype.itemsize}")
+    check(np.array_equal(rec.ee, EE), f"{path}: EEPROM image")
+    for i in range(len(rec)):
+        g = gen(i)
+        ok = (r["seq"][i] == g.seq and r["subpage"][i] == g.subpage and r["t_us"][i] == g.t_us
+              and r["ta"][i] == round(g.ta * 100) and np.array_equal(r["raw"][i], g.raw)
+              and np.array_equal(r["to"][i], g.centi))
+        check(ok, f"{path}: record {i}")
+        if not ok:
+            break
+    if rec.index is not None:
+        check(rec.stride > 1 or len(rec) <= INDEX_CAP, f"{path}: index never decimated")
+        e = np.arange(len(rec.index), dtype=np.uint64)
+        check(np.array_equal(rec.index["record"], e * rec.stride), f"{path}: index records")
+        check(np.array_equal(rec.index["t_us"], r["t_us"][rec.index["record"].astype(np.int64)]),
+              f"{path}: index times")
+    t = np.asarray(r["t_us"])
+    probes = np.concatenate([t - 1, t, t + 1, [t[-1] + 2 if len(t) else 0, -(1 << 62)]])
+    for p in probes:
+        check(rec.seek(int(p)) == int(np.searchsorted(t, p, side="left")), f"{path}: seek({p})")
+    print(f"{path}: {len(rec)} records, {'truncated' if rec.truncated else 'footer ok'}, "
+          f"index {0 if rec.index is None else len(rec.index)} x stride {rec.stride}")
+    return rec
+
+
+def truncate(src, dst, records, extra):
+    """保留文件头 + records 条记录 + extra 字节的半条记录，去掉索引和尾部"""
+    rec = mlx_rec.Recording(src)
+    end = int(rec.header["header_size"]) + records * int(rec.header["record_size"]) + extra
+    del rec
+    with open(src, "rb") as f:
+        data = f.read(end)
+    with open(dst, "wb") as f:
+        f.write(data)
+
+
+def main():
+    tmp = tempfile.mkdtemp(prefix="mlx_rec_test_")
+    try:
+        exe = sys.argv[1] if len(sys.argv) > 1 else build(tmp)
+        c_rec, py_rec = os.path.join(tmp, "c.rec"), os.path.join(tmp, "py.rec")
+
+        def c_check(path, n, *extra):
+            check(subprocess.run([exe, "check", path, str(n), *extra]).returncode == 0, f"C check {path}")
+
+        # C 写 → Python 读（含索引隔项丢弃 + seek）
+        subprocess.run([exe, "write", c_rec, str(N), str(CONTENTS), str(INDEX_CAP)], check=True)
+        py_check(c_rec, N)
+        # Python 写 → C 读，两边写出的文件应逐字节相同
+        py_write(py_rec, N)
+        c_check(py_rec, N)
+        with open(c_rec, "rb") as a, open(py_rec, "rb") as b:
+            check(a.read() == b.read(), "C and Python writers differ")
+
+        # 尾部缺失：最后半条记录丢弃，没有索引，seek 全程二分
+        for src in (c_rec, py_rec):
+            cut = src + ".cut"
+            truncate(src, cut, 123, 700)
+            py_check(cut, 123, truncated=True)
+            c_check(cut, 123, "truncated")
+
+        # 空录制
+        empty = os.path.join(tmp, "empty.rec")
+        py_write(empty, 0)
+        py_check(empty, 0)
+        c_check(empty, 0)
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+    print("FAILED" if failures else "all ok")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
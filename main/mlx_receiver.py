@@ -0,0 +1,322 @@
+"""
+MLX90640 串口接收（mlx_s3.py / mlx90640_viewer.py 共用）
+
+同时识别设备的三种帧输出，无需事先知道设备当前用哪一种：
+
+  binary / delta   COBS 二进制包（mlx_proto.py）
+  csv              FRAME_BEGIN / 24 行 CSV / FRAME_END
+  text             ESP_LOG 的 "Row NN: ..." 矩阵
+
+  rx = Receiver(serial.Serial(port, 115200, timeout=0.1))
+  rx.start()
+  for frame in rx:                  # mlx_proto.Frame，frame.to 为 (24, 32) °C
+      ...
+
+后台线程按块读取串口（不逐行 readline），整帧用 numpy 一次转换，
+解好的帧进入有界队列；消费端跟不上时丢弃最旧的帧并计入 stats["dropped"]。
+界面用 Receiver(ser, latest=True) + take()：只保留最新一帧（Mailbox），
+显示延迟与输入帧率无关。
+坏包、半帧、行数不对的文本帧直接丢弃，从下一个完整帧重新同步。
+二进制输出时设备每个统计周期随帧发一个 METRICS 包，最近一条在 rx.metrics（mlx_proto.Metrics）。
+"""
+import queue
+import re
+import sys
+import threading
+
+import numpy as np
+
+import mlx_proto
+from mlx_proto import COLS, ROWS, Frame
+
+ANSI_ESCAPE = re.compile(rb"\x1B(?:[@-Z\\-_]|\[[0-?]*[ -/]*[@-~])")
+ROW_PATTERN = re.compile(rb"Row\s+(\d+):(.*)$")
+
+
+def select_port():
+    """列出串口让用户选择，返回设备名"""
+    import serial.tools.list_ports
+
+    ports = list(serial.tools.list_ports.comports())
+    if not ports:
+        print("No serial ports found.")
+        sys.exit(1)
+
+    for i, p in enumerate(ports):
+        print(f"{i}: {p.device}")
+    while True:
+        try:
+            sel = input("Select port (enter index or device name): ").strip()
+        except KeyboardInterrupt:
+            sys.exit(0)
+        if sel.isdigit() and int(sel) < len(ports):
+            return ports[int(sel)].device
+        if any(p.device == sel for p in ports):
+            return sel
+        print("Invalid selection. Try again.")
+
+
+def _text_frame(seq, to):
+    nan = float("nan")
+    return Frame(seq, 0, nan, nan, 0, 0, to.reshape(ROWS, COLS))
+
+
+class StreamParser:
+    """
+    字节流 → 帧列表。
+
+    二进制包以 0x00 开头和结尾，文本里不会出现 0x00：
+    紧跟在 0x00 后的数据先当作二进制包等到下一个 0x00 再解码，解码失败的段按文本处理；
+    没有 0x00 的纯文本流逐行即时解析。超过 max_len 仍没有结束符的段也按文本处理。
+    """
+
+    def __init__(self, max_len=8192):
+        self.buf = bytearray()
+        self.max_len = max_len
+        self.after_zero = False     # buf 开头紧跟在 0x00 之后
+        self.decoder = mlx_proto.FrameDecoder()
+        self.text_seq = 0
+        self.csv_rows = None        # FRAME_BEGIN 之后收集的行
+        self.text_rows = {}
+        self.metrics = None         # 最近一个 METRICS 包
+        self.stats = {"frames": 0, "bad": 0, "bytes": 0, "metrics": 0}
+
+    def feed(self, data):
+        self.stats["bytes"] += len(data)
+        self.buf += data
+        frames = []
+
+        while True:
+            end = self.buf.find(b"\x00")
+            if end < 0:
+                break
+            seg = bytes(self.buf[:end])
+            del self.buf[:end + 1]
+            if seg:
+                self._segment(seg, frames)
+            self.after_zero = True
+
+        if self.after_zero and len(self.buf) > self.max_len:
+            self.after_zero = False     # 长时间没有结束符，不是二进制包
+        if not self.after_zero:
+            # 纯文本：处理已完整的行，剩下半行等下次
+            cut = self.buf.rfind(b"\n") + 1
+            if cut == 0 and len(self.buf) > self.max_len:
+                cut = len(self.buf)
+            if cut:
+                self._text(bytes(self.buf[:cut]), frames)
+                del self.buf[:cut]
+
+        self.stats["frames"] += len(frames)
+        return frames
+
+    # ================= 二进制 =================
+    def _segment(self, seg, frames):
+        pkt = mlx_proto.decode_packet(seg)
+        if pkt is None:
+            # 夹在包之间的日志行按文本解析，其余计为坏包
+            if seg.isascii():
+                self._text(seg, frames)
+            else:
+                self.stats["bad"] += 1
+            return
+        if pkt[0] == mlx_proto.TYPE_METRICS:
+            metrics = mlx_proto.parse_metrics(pkt[1])
+            if metrics is not None:
+                self.metrics = metrics
+                self.stats["metrics"] += 1
+            return
+        frame = self.decoder.decode(*pkt)
+        if frame is not None:
+            frames.append(frame)
+
+    # ================= 文本 =================
+    def _text(self, data, frames):
+        for line in ANSI_ESCAPE.sub(b"", data).split(b"\n"):
+            line = line.strip()
+            if line:
+                self._line(line, frames)
+
+    def _line(self, line, frames):
+        if line == b"FRAME_BEGIN":
+            self.csv_rows = []
+            return
+        if self.csv_rows is not None:
+            if line != b"FRAME_END":
+                self.csv_rows.append(line)
+                return
+            rows, self.csv_rows = self.csv_rows, None
+            to = self._parse(b",".join(rows), b",")
+            if to is not None:
+                frames.append(_text_frame(self.text_seq, to))
+                self.text_seq += 1
+            return
+
+        m = ROW_PATTERN.search(line)
+        if m is None:
+            return
+        row = int(m.group(1))
+        if row == 0:
+            self.text_rows.clear()
+        self.text_rows[row] = m.group(2)
+        if row == ROWS - 1:
+            rows, self.text_rows = self.text_rows, {}
+            if len(rows) != ROWS:
+                self.stats["bad"] += 1
+                return
+            to = self._parse(b" ".join(rows[r] for r in range(ROWS)), None)
+            if to is not None:
+                frames.append(_text_frame(self.text_seq, to))
+                self.text_seq += 1
+
+    def _parse(self, data, sep):
+        try:
+            to = np.array(data.split(sep), dtype=np.float32)
+        except ValueError:
+            to = None
+        if to is None or to.size != ROWS * COLS:
+            self.stats["bad"] += 1
+            return None
+        return to
+
+
+class Mailbox:
+    """最新帧优先：只有一个槽位，新帧覆盖还没被取走的旧帧"""
+
+    def __init__(self):
+        self._cond = threading.Condition()
+        self._item = None
+        self._full = False
+        self.closed = False
+        self.overwritten = 0
+
+    def put(self, item):
+        with self._cond:
+            if self._full:
+                self.overwritten += 1
+            self._item = item
+            self._full = True
+            self._cond.notify()
+
+    def take(self):
+        """不阻塞：有新帧返回新帧，否则返回 None"""
+        with self._cond:
+            item, self._item, self._full = self._item, None, False
+            return item
+
+    def get(self, timeout=None):
+        with self._cond:
+            self._cond.wait_for(lambda: self._full or self.closed, timeout)
+        return self.take()
+
+    def close(self):
+        """生产端结束：已放入的最后一帧仍可取走，之后 get 不再阻塞"""
+        with self._cond:
+            self.closed = True
+            self._cond.notify_all()
+
+
+class Receiver:
+    """后台线程读串口 + 解析，帧经有界队列（或 latest=True 时的 Mailbox）交给消费端"""
+
+    def __init__(self, stream, maxsize=8, read_size=65536, latest=False):
+        self.stream = stream
+        self.read_size = read_size
+        self.parser = StreamParser()
+        self.mailbox = Mailbox() if latest else None
+        self.frames = queue.Queue(maxsize)
+        self._dropped = 0
+        self.error = None
+        self._stop = threading.Event()
+        self._thread = None
+
+    @property
+    def dropped(self):
+        return self.mailbox.overwritten if self.mailbox else self._dropped
+
+    @property
+    def stats(self):
+        return dict(self.parser.stats, dropped=self.dropped)
+
+    @property
+    def metrics(self):
+        """设备最近一次的资源监控（mlx_proto.Metrics），还没收到为 None"""
+        return self.parser.metrics
+
+    def start(self):
+        self._thread = threading.Thread(target=self._run, daemon=True)
+        self._thread.start()
+        return self
+
+    def stop(self):
+        self._stop.set()
+        if self._thread is not None:
+            self._thread.join(timeout=1)
+
+    def _run(self):
+        while not self._stop.is_set():
+            try:
+                # pyserial：有多少读多少，没有数据时由 timeout 限制阻塞时间
+                if hasattr(self.stream, "in_waiting"):
+                    n = max(1, self.stream.in_waiting)
+                else:
+                    n = self.read_size
+                data = self.stream.read(n)
+            except Exception as e:      # 串口被拔出等
+                self.error = e
+                break
+            if not data:
+                if not hasattr(self.stream, "in_waiting"):
+                    break               # 普通文件读完（回放录下的串口数据）
+                continue
+            for frame in self.parser.feed(data):
+                self._put(frame)
+        if self.mailbox is not None:
+            self.mailbox.close()
+        else:
+            self._put(None)             # 通知消费端结束
+
+    def _put(self, frame):
+        if self.mailbox is not None:
+            self.mailbox.put(frame)
+            return
+        while True:
+            try:
+                self.frames.put_nowait(frame)
+                return
+            except queue.Full:
+                try:
+                    self.frames.get_nowait()
+                    self._dropped += 1
+                except queue.Empty:
+                    pass
+
+    def get(self, timeout=None):
+        """取下一帧；超时或接收结束返回 None"""
+        if self.mailbox is not None:
+            return self.mailbox.get(timeout)
+        try:
+            return self.frames.get(timeout=timeout)
+        except queue.Empty:
+            return None
+
+    def take(self):
+        """不阻塞地取最新一帧，队列模式下会丢弃更早的帧（计入 dropped）"""
+        if self.mailbox is not None:
+            return self.mailbox.take()
+        frame = None
+        while True:
+            try:
+                newer = self.frames.get_nowait()
+            except queue.Empty:
+                return frame
+            if frame is not None:
+                self._dropped += 1
+            frame = newer
+
+    def __iter__(self):
+        while True:
+            frame = self.get()
+            if frame is None:
+                return
+            yield frame
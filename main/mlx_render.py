@@ -0,0 +1,74 @@
+"""
+热图 blit 渲染（mlx_s3.py / mlx90640_viewer.py 共用）
+
+每帧只把 32x24 图像和标题文字画到缓存的背景上再 blit，
+坐标轴、色标等静态部分不重画。色标范围按 step 取整并带滞回，
+只有温度范围明显变化时才整图重绘一次（full_draws 计数）。
+"""
+import math
+
+import numpy as np
+
+from mlx_proto import COLS, ROWS
+
+
+class HeatmapRenderer:
+    def __init__(self, fig, ax, cmap="inferno", step=1.0):
+        self.fig = fig
+        self.ax = ax
+        self.canvas = fig.canvas
+        self.step = step
+        self.clim = (20.0, 40.0)
+        self.bg = None
+        self.frames = 0
+        self.full_draws = 0
+
+        self.img = ax.imshow(
+            np.zeros((ROWS, COLS), dtype=np.float32),
+            cmap=cmap,
+            vmin=self.clim[0],
+            vmax=self.clim[1],
+            interpolation="nearest",
+            animated=True,
+        )
+        self.colorbar = fig.colorbar(self.img, ax=ax)
+        self.label = ax.set_title("Waiting for frames...", animated=True)
+
+        # 任何整图重绘（首次显示、缩放窗口、色标变化）之后重新截取背景
+        self.canvas.mpl_connect("draw_event", self._on_draw)
+
+    def _on_draw(self, event):
+        self.bg = self.canvas.copy_from_bbox(self.fig.bbox)
+        self._draw_animated()
+
+    def _draw_animated(self):
+        self.fig.draw_artist(self.img)
+        self.fig.draw_artist(self.label)
+
+    def _limits(self, lo, hi):
+        """当前范围仍能覆盖且不超过 2 个 step 的余量时保持不变"""
+        new_lo = math.floor(lo / self.step) * self.step
+        new_hi = max(math.ceil(hi / self.step) * self.step, new_lo + self.step)
+        cur_lo, cur_hi = self.clim
+        if cur_lo <= lo and hi <= cur_hi and (cur_hi - cur_lo) <= (new_hi - new_lo) + 2 * self.step:
+            return self.clim
+        return (new_lo, new_hi)
+
+    def show(self, to, text=None):
+        lo = float(np.nanmin(to))
+        hi = float(np.nanmax(to))
+        clim = self._limits(lo, hi)
+
+        self.img.set_data(to)
+        self.label.set_text(text if text is not None else f"{lo:.1f}C ~ {hi:.1f}C")
+
+        if clim != self.clim or self.bg is None:
+            self.clim = clim
+            self.img.set_clim(*clim)
+            self.full_draws += 1
+            self.canvas.draw()          # 触发 draw_event，重新截背景并画出图像
+        else:
+            self.canvas.restore_region(self.bg)
+            self._draw_animated()
+        self.canvas.blit(self.fig.bbox)
+        self.frames += 1
@@ -1,83 +1,50 @@
 import serial
-import serial.tools.list_ports
-import threading
-import numpy as np
 import tkinter as tk
 from matplotlib.backends.backend_tkagg import FigureCanvasTkAgg
-import matplotlib.pyplot as plt
+from matplotlib.figure import Figure
 
-WIDTH, HEIGHT = 32, 24
+from mlx_receiver import Receiver, select_port
+from mlx_render import HeatmapRenderer
+
+POLL_MS = 10        # 界面取帧间隔，决定最大显示延迟
 
 class HeatmapApp:
-    def __init__(self, root, ser):
-        self.ser = ser
+    def __init__(self, root, rx):
+        self.rx = rx
         self.root = root
 
-        self.fig, self.ax = plt.subplots(figsize=(4, 3))
-        self.data = np.zeros((HEIGHT, WIDTH))
-
-        self.img = self.ax.imshow(
-            self.data,
-            cmap="inferno",
-            vmin=20,
-            vmax=40,
-            interpolation="nearest"
-        )
-        self.ax.set_title("Waiting for BOOT key...")
-        self.colorbar = self.fig.colorbar(self.img)
-
+        # 不经过 pyplot，避免交互模式在每次 set_data 后触发整图重绘
+        self.fig = Figure(figsize=(4, 3))
+        self.ax = self.fig.add_subplot()
         self.canvas = FigureCanvasTkAgg(self.fig, master=root)
         self.canvas.get_tk_widget().pack(fill=tk.BOTH, expand=True)
 
-        threading.Thread(target=self.serial_thread, daemon=True).start()
-
-    def serial_thread(self):
-        while True:
-            line = self.ser.readline().decode(errors="ignore").strip()
-            if line != "FRAME_BEGIN":
-                continue
-
-            values = []
-            while True:
-                line = self.ser.readline().decode(errors="ignore").strip()
-                if line == "FRAME_END":
-                    break
-                values.extend(line.split(","))
-
-            if len(values) != 768:
-                print("Invalid frame length:", len(values))
-                continue
-
-            frame = np.array(values, dtype=np.float32).reshape(HEIGHT, WIDTH)
-            self.update_image(frame)
-
-    def update_image(self, frame):
-        vmin = np.min(frame)
-        vmax = np.max(frame)
+        self.renderer = HeatmapRenderer(self.fig, self.ax)
+        self.renderer.label.set_text("Waiting for BOOT key...")
 
-        self.img.set_data(frame)
-        self.img.set_clim(vmin, vmax)
-        self.ax.set_title(f"{vmin:.1f}C ~ {vmax:.1f}C")
-        self.canvas.draw_idle()
+        # 串口线程只往 Mailbox 里放最新帧，界面线程定时取走并 blit
+        self.root.after(POLL_MS, self.poll)
 
-def select_port():
-    ports = list(serial.tools.list_ports.comports())
-    for i, p in enumerate(ports):
-        print(f"{i}: {p.device}")
-    idx = int(input("Select port: "))
-    return ports[idx].device
+    def poll(self):
+        frame = self.rx.take()
+        if frame is not None:
+            self.renderer.show(frame.to)
+        self.root.after(POLL_MS, self.poll)
 
 def main():
     port = select_port()
-    ser = serial.Serial(port, 115200, timeout=1)
+    ser = serial.Serial(port, 115200, timeout=0.1)
+    rx = Receiver(ser, latest=True).start()
     print("Connected to", port)
 
     root = tk.Tk()
     root.title("MLX90640 Heatmap")
     root.geometry("320x240")
 
-    HeatmapApp(root, ser)
+    app = HeatmapApp(root, rx)
     root.mainloop()
+    rx.stop()
+    print("shown", app.renderer.frames, "full redraws", app.renderer.full_draws, rx.stats)
 
 if __name__ == "__main__":
     main()
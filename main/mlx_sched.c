@@ -0,0 +1,185 @@
+#include "mlx_sched.h"
+
+#include <string.h>
+#include <inttypes.h>
+
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+
+#include "MLX90640_API.h"
+#include "MLX90640_I2C_Driver.h"
+
+#define TAG "MLX_SCHED"
+
+#define PHASE_GAIN_SHIFT    1       // 相位误差每周期修正 1/2
+#define PERIOD_GAIN_SHIFT   4       // 周期估计每周期修正 1/16
+#define RELOCK_DIVISOR      4       // 误差超过周期的 1/4 视为失锁
+#define POLL_GAP_US         250     // 最后一个 tick 内两次读状态之间的间隔
+
+static void stat_add(mlx_sched_stat_t *st, int64_t us)
+{
+    st->count++;
+    st->sum_us += us;
+    if (us > st->max_us) {
+        st->max_us = us;
+    }
+}
+
+static int64_t abs64(int64_t v)
+{
+    return v < 0 ? -v : v;
+}
+
+void mlx_sched_init(mlx_sched_t *s, int64_t period_us, int64_t margin_us)
+{
+    memset(s, 0, sizeof(*s));
+    s->nominal_us = period_us;
+    s->period_us = period_us;
+    s->margin_us = margin_us;
+}
+
+void mlx_sched_unlock(mlx_sched_t *s)
+{
+    s->locked = false;
+}
+
+/* ================= 睡眠 ================= */
+
+/*
+ * 按绝对 tick 睡到 wake_us 之前最近的 tick，最多早醒一个 tick；
+ * 余下的部分由 pace_poll 分段睡，不在 I2C 上连续轮询（需要 CONFIG_FREERTOS_HZ=1000，见 sdkconfig.defaults）
+ */
+static void sleep_until(mlx_sched_t *s, int64_t wake_us)
+{
+    const int64_t tick_us = portTICK_PERIOD_MS * 1000;
+    TickType_t target = (TickType_t)((wake_us - s->anchor_us) / tick_us);
+    TickType_t now_tick = xTaskGetTickCount() - s->wake_tick;
+
+    /* TickType_t 回绕后仍然成立；已经过点就不睡 */
+    if ((int32_t)(target - now_tick) > 0) {
+        TickType_t prev = s->wake_tick;
+        TickType_t inc = target;
+        xTaskDelayUntil(&prev, inc);
+    }
+}
+
+/*
+ * 两次读状态之间：离预测就绪还有一个 tick 以上就让出 CPU 睡一个 tick，
+ * 否则隔 POLL_GAP_US 再读。未锁相时就绪时刻未知，只做短间隔。
+ */
+static void pace_poll(mlx_sched_t *s)
+{
+    const int64_t tick_us = portTICK_PERIOD_MS * 1000;
+
+    if (s->locked && s->ready_us - esp_timer_get_time() > tick_us) {
+        vTaskDelay(1);
+    } else {
+        esp_rom_delay_us(POLL_GAP_US);
+    }
+}
+
+/* ================= 等待 data-ready ================= */
+int mlx_sched_wait_ready(mlx_sched_t *s, uint8_t slaveAddr)
+{
+    int64_t wake_plan = s->ready_us - s->margin_us;
+
+    if (s->locked) {
+        int64_t now = esp_timer_get_time();
+
+        /* 上一周期处理超时：跳过已经错过的周期，不去追 */
+        while (wake_plan + s->period_us <= now) {
+            s->ready_us += s->period_us;
+            wake_plan += s->period_us;
+            s->misses++;
+        }
+        sleep_until(s, wake_plan);
+        stat_add(&s->wake, esp_timer_get_time() - wake_plan);
+    }
+
+    uint16_t status;
+    uint32_t polls = 0;
+    while (1) {
+        int error = MLX90640_I2CRead(slaveAddr, MLX90640_STATUS_REG, 1, &status);
+        if (error != 0) {
+            s->locked = false;
+            return error;
+        }
+        polls++;
+        if (MLX90640_GET_DATA_READY(status)) {
+            break;
+        }
+        pace_poll(s);
+    }
+    s->waits++;
+    s->polls += polls;
+    if (polls > s->polls_max) {
+        s->polls_max = polls;
+    }
+
+    /* 第一次轮询就已就绪时，真实就绪时刻只知道早于现在 */
+    int64_t observed = esp_timer_get_time();
+    s->observed_us = observed;
+
+    if (!s->locked) {
+        s->locked = true;
+        s->relocks++;
+        s->period_us = s->nominal_us;
+        s->ready_us = observed + s->period_us;
+        s->wake_tick = xTaskGetTickCount();
+        s->anchor_us = esp_timer_get_time();
+        return 0;
+    }
+
+    int64_t err = observed - s->ready_us;
+    stat_add(&s->phase, abs64(err));
+    if (polls == 1 && err > 0) {
+        s->misses++;        // 醒来时数据已经在等了
+    }
+
+    if (abs64(err) > s->period_us / RELOCK_DIVISOR) {
+        s->locked = false;
+        return 0;           // 本次数据照常读取，下一次重新捕获
+    }
+
+    /* 比例项修正相位，积分项跟踪传感器振荡器的实际周期 */
+    s->period_us += err >> PERIOD_GAIN_SHIFT;
+    s->ready_us += s->period_us + (err >> PHASE_GAIN_SHIFT);
+    return 0;
+}
+
+void mlx_sched_frame_done(mlx_sched_t *s, int64_t now_us)
+{
+    if (s->observed_us) {
+        stat_add(&s->latency, now_us - s->observed_us);
+    }
+}
+
+/* ================= 统计 ================= */
+void mlx_sched_report(mlx_sched_t *s)
+{
+    const struct { const char *name; mlx_sched_stat_t *st; } rows[] = {
+        { "wake",    &s->wake },
+        { "phase",   &s->phase },
+        { "latency", &s->latency },
+    };
+
+    ESP_LOGI(TAG, "period %" PRId64 "us (nominal %" PRId64 "us)  misses=%" PRIu32 "  relocks=%" PRIu32
+             "  polls avg=%.1f max=%" PRIu32,
+             s->period_us, s->nominal_us, s->misses, s->relocks,
+             s->waits ? (float)s->polls / s->waits : 0.0f, s->polls_max);
+    for (int i = 0; i < 3; i++) {
+        mlx_sched_stat_t *st = rows[i].st;
+        if (st->count) {
+            ESP_LOGI(TAG, "  %-7s avg=%" PRId64 "us max=%" PRId64 "us",
+                     rows[i].name, st->sum_us / st->count, st->max_us);
+        }
+        memset(st, 0, sizeof(*st));
+    }
+    s->misses = 0;
+    s->relocks = 0;
+    s->waits = 0;
+    s->polls = 0;
+    s->polls_max = 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+
+/*
+ * 与传感器 data-ready 锁相的周期调度
+ *
+ * 传感器内部振荡器和标称刷新率有几个百分点的偏差，固定周期睡眠会慢慢漂移。
+ * 这里每个子页都在 data-ready 附近轮询状态寄存器，用观测到的就绪时刻
+ * 修正下一次的预测（比例 + 积分，积分项跟踪实际周期），
+ * 再用 xTaskDelayUntil 按绝对 tick 睡到“预测就绪 - margin”。
+ * tick 取整最多早醒一个 tick，剩下的时间在两次读状态之间继续睡，
+ * 所以依赖 1ms 的 tick（CONFIG_FREERTOS_HZ=1000），100Hz 时会早醒到 10ms。
+ *
+ * 统计：
+ *   wake    实际唤醒相对计划唤醒的延迟（任务调度抖动）
+ *   phase   观测就绪时刻相对预测的偏差（锁相误差）
+ *   latency 就绪到帧可用（子页读完、算完、入队）
+ *   misses  醒来时已超过预测就绪时刻，或处理超时跳过了整周期
+ *   polls   每个子页读状态寄存器的次数（平均 / 最大），衡量空轮询
+ */
+
+typedef struct {
+    uint32_t count;
+    int64_t  sum_us;
+    int64_t  max_us;
+} mlx_sched_stat_t;
+
+typedef struct {
+    int64_t  nominal_us;        // 标称子页周期
+    int64_t  period_us;         // 跟踪到的实际周期
+    int64_t  margin_us;         // 提前醒来的余量
+    int64_t  ready_us;          // 预测的下一次 data-ready
+    int64_t  observed_us;       // 最近一次观测到的 data-ready
+
+    bool       locked;
+    TickType_t wake_tick;       // xTaskDelayUntil 的参考 tick
+    int64_t    anchor_us;       // wake_tick 对应的 esp_timer 时间
+
+    /* 统计窗口 */
+    mlx_sched_stat_t wake;
+    mlx_sched_stat_t phase;
+    mlx_sched_stat_t latency;
+    uint32_t misses;
+    uint32_t relocks;
+    uint32_t waits;
+    uint32_t polls;
+    uint32_t polls_max;
+} mlx_sched_t;
+
+void mlx_sched_init(mlx_sched_t *s, int64_t period_us, int64_t margin_us);
+
+/* 相位失效（暂停、SynchFrame、总线恢复后），下一次重新捕获 */
+void mlx_sched_unlock(mlx_sched_t *s);
+
+/* 睡到下一次唤醒点并轮询到 data-ready；返回 0 或 I2C 错误码 */
+int  mlx_sched_wait_ready(mlx_sched_t *s, uint8_t slaveAddr);
+
+/* 本子页处理完、帧已交给下游 */
+void mlx_sched_frame_done(mlx_sched_t *s, int64_t now_us);
+
+/* 打印并清零统计窗口 */
+void mlx_sched_report(mlx_sched_t *s);
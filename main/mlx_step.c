@@ -0,0 +1,167 @@
+#include "mlx_step.h"
+
+#include <string.h>
+
+#include "MLX90640_API.h"
+#include "MLX90640_I2C_Driver.h"
+
+#define CAPTURE_ATTEMPTS    3       // 子页顺序被打乱时最多多读一个
+#define WAKE_EARLY_SHIFT    4       // 提前 1/16 个转换时间醒来，吸收振荡器偏差
+#define READY_TIMEOUT_MUL   2       // 触发后 2 个转换时间还没 data-ready 视为触发失败
+
+void mlx_step_init(mlx_step_t *st, uint8_t slaveAddr,
+                   mlx_step_now_fn now_us, mlx_step_sleep_fn sleep_us, void *ctx)
+{
+    memset(st, 0, sizeof(*st));
+    st->slave_addr = slaveAddr;
+    st->now_us = now_us;
+    st->sleep_us = sleep_us;
+    st->ctx = ctx;
+    st->min_sleep_us = 2000;
+    st->window_start_us = now_us(ctx);
+}
+
+int mlx_step_enable(mlx_step_t *st, bool on)
+{
+    uint16_t ctrl;
+    int error = MLX90640_I2CRead(st->slave_addr, MLX90640_CTRL_REG, 1, &ctrl);
+    if (error != 0) {
+        return error;
+    }
+
+    if (on) {
+        ctrl |= MLX_STEP_CTRL_STEP_MODE;
+    } else {
+        ctrl &= (uint16_t)~MLX_STEP_CTRL_STEP_MODE;
+    }
+    error = MLX90640_I2CWrite(st->slave_addr, MLX90640_CTRL_REG, ctrl);
+    if (error != 0) {
+        return error;
+    }
+
+    int rate = (ctrl & ~MLX90640_CTRL_REFRESH_MASK) >> MLX90640_CTRL_REFRESH_SHIFT;
+    st->conv_us = 2000000 >> rate;
+    return 0;
+}
+
+/* ================= 睡眠 ================= */
+static void sleep_for(mlx_step_t *st, int64_t us)
+{
+    if (us < st->min_sleep_us) {
+        return;
+    }
+    int64_t t0 = st->now_us(st->ctx);
+    st->sleep_us(us, st->ctx);
+    st->slept_us += st->now_us(st->ctx) - t0;
+}
+
+void mlx_step_sleep_until(mlx_step_t *st, int64_t t_us)
+{
+    sleep_for(st, t_us - st->now_us(st->ctx));
+}
+
+/* ================= 采集 ================= */
+
+/*
+ * 醒来后轮询 data-ready，超过 deadline_us 返回触发错误。
+ * GetFrameData 自己的轮询没有上限，general call 没送到时会一直卡在那里；
+ * 这里确认就绪后它第一次读状态就会返回。
+ */
+static int wait_ready(mlx_step_t *st, int64_t deadline_us)
+{
+    uint16_t status;
+
+    while (1) {
+        int error = MLX90640_I2CRead(st->slave_addr, MLX90640_STATUS_REG, 1, &status);
+        if (error != 0) {
+            return error;
+        }
+        st->polls++;
+        if (MLX90640_GET_DATA_READY(status)) {
+            return 0;
+        }
+        if (st->now_us(st->ctx) >= deadline_us) {
+            st->timeouts++;
+            return -MLX90640_MEAS_TRIGGER_ERROR;
+        }
+    }
+}
+
+int mlx_step_read_subpage(mlx_step_t *st, uint16_t *frameData)
+{
+    /* 清掉上一次的 data-ready，GetFrameData 只会等到本次触发的结果 */
+    int error = MLX90640_I2CWrite(st->slave_addr, MLX90640_STATUS_REG, MLX90640_INIT_STATUS_VALUE);
+    if (error == 0) {
+        error = MLX90640_TriggerMeasurement(st->slave_addr);
+    }
+    if (error != 0) {
+        st->errors++;
+        return error;
+    }
+    st->triggers++;
+    int64_t deadline = st->now_us(st->ctx) + st->conv_us * READY_TIMEOUT_MUL;
+
+    sleep_for(st, st->conv_us - (st->conv_us >> WAKE_EARLY_SHIFT));
+
+    int ret = wait_ready(st, deadline);
+    if (ret == 0) {
+        ret = MLX90640_GetFrameData(st->slave_addr, frameData);
+    }
+    if (ret < 0) {
+        st->errors++;
+    }
+    return ret;
+}
+
+int mlx_step_capture(mlx_step_t *st, mlx_frame_assembler_t *fa, uint16_t *frameData,
+                     mlx_frame_t *out)
+{
+    mlx_frame_assembler_reset(fa);
+
+    for (int i = 0; i < CAPTURE_ATTEMPTS; i++) {
+        int ret = mlx_step_read_subpage(st, frameData);
+        if (ret < 0) {
+            return ret;
+        }
+        int64_t t = st->now_us(st->ctx);
+        if (mlx_frame_assembler_push(fa, frameData, t, out)) {
+            st->captures++;
+            return 0;
+        }
+    }
+
+    st->errors++;
+    return -MLX90640_FRAME_DATA_ERROR;
+}
+
+/* ================= 统计 ================= */
+void mlx_step_report(mlx_step_t *st, float active_ma, float sleep_ma, mlx_step_report_t *out)
+{
+    int64_t now = st->now_us(st->ctx);
+    int64_t total = now - st->window_start_us;
+    int64_t awake = total - st->slept_us;
+
+    memset(out, 0, sizeof(*out));
+    out->captures = st->captures;
+    out->errors = st->errors;
+    out->timeouts = st->timeouts;
+    if (st->triggers) {
+        out->polls = (float)st->polls / st->triggers;
+    }
+    if (total > 0) {
+        out->duty = (float)awake / total;
+        out->avg_ma = (awake * active_ma + st->slept_us * sleep_ma) / total;
+    }
+    if (st->captures) {
+        out->awake_ms = awake / 1000.0f / st->captures;
+        out->period_ms = total / 1000.0f / st->captures;
+    }
+
+    st->window_start_us = now;
+    st->slept_us = 0;
+    st->triggers = 0;
+    st->captures = 0;
+    st->errors = 0;
+    st->timeouts = 0;
+    st->polls = 0;
+}
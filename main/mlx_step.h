@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "mlx_frame.h"
+
+/*
+ * step 模式低功耗采集
+ *
+ * 传感器不再自由运行：每个子页由 MLX90640_TriggerMeasurement 触发一次转换，
+ * 转换期间 MCU 睡眠（设备上是 light sleep），醒来后读数据；两个子页
+ * 拼成整帧后再睡到下一次采集。醒来后轮询 data-ready 有时间上限，
+ * 触发没生效（general call 没送到）时返回 -MLX90640_MEAS_TRIGGER_ERROR 而不是卡住。睡眠和时钟通过回调注入，主机上可以接到
+ * 仿真器的虚拟时钟上验证时序和功耗估算。
+ *
+ * 平均电流按时间加权估算：
+ *   I = (t_awake * active_ma + t_sleep * sleep_ma) / t_total
+ * 不含传感器自身电流。
+ */
+
+#define MLX_STEP_CTRL_STEP_MODE     BIT_MASK(1)     // 控制寄存器 0x800D bit1
+
+typedef int64_t (*mlx_step_now_fn)(void *ctx);
+typedef void    (*mlx_step_sleep_fn)(int64_t us, void *ctx);
+
+typedef struct {
+    uint8_t  slave_addr;
+    mlx_step_now_fn   now_us;
+    mlx_step_sleep_fn sleep_us;
+    void    *ctx;
+    int64_t  min_sleep_us;      // 短于此不睡，直接轮询（进出 light sleep 有固定开销）
+    int64_t  conv_us;           // 一个子页的转换时间，由刷新率决定
+
+    /* 统计窗口 */
+    int64_t  window_start_us;
+    int64_t  slept_us;
+    uint32_t triggers;
+    uint32_t captures;
+    uint32_t errors;
+    uint32_t timeouts;          // 触发后等不到 data-ready
+    uint32_t polls;             // 醒来后读状态寄存器的次数
+} mlx_step_t;
+
+typedef struct {
+    uint32_t captures;
+    uint32_t errors;
+    uint32_t timeouts;
+    float    polls;             // 每次触发的平均状态轮询次数
+    float    awake_ms;          // 每次采集的平均唤醒时间
+    float    period_ms;         // 平均采集间隔
+    float    duty;              // 唤醒占比
+    float    avg_ma;
+} mlx_step_report_t;
+
+void mlx_step_init(mlx_step_t *st, uint8_t slaveAddr,
+                   mlx_step_now_fn now_us, mlx_step_sleep_fn sleep_us, void *ctx);
+
+/* 打开 / 关闭传感器的 step 模式；打开时按当前刷新率计算转换时间 */
+int  mlx_step_enable(mlx_step_t *st, bool on);
+
+/* 触发一次转换、睡过转换时间、读回子页；返回子页号或错误码 */
+int  mlx_step_read_subpage(mlx_step_t *st, uint16_t *frameData);
+
+/* 读两个子页拼成一整帧，成功返回 0 */
+int  mlx_step_capture(mlx_step_t *st, mlx_frame_assembler_t *fa, uint16_t *frameData,
+                      mlx_frame_t *out);
+
+void mlx_step_sleep_until(mlx_step_t *st, int64_t t_us);
+
+/* 汇总统计窗口并清零 */
+void mlx_step_report(mlx_step_t *st, float active_ma, float sleep_ma, mlx_step_report_t *out);
@@ -0,0 +1,136 @@
+#include "mlx_sysmon.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#define TAG "MLX_SYSMON"
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+#define SYSMON_RUNTIME 1
+#else
+#define SYSMON_RUNTIME 0
+#endif
+
+#if SYSMON_RUNTIME
+/* 上一次采样的各任务运行时间计数，按句柄对应 */
+static struct {
+    TaskHandle_t handle;
+    configRUN_TIME_COUNTER_TYPE runtime;
+} prev[MLX_SYSMON_MAX_TASKS + 4];
+static int prev_count;
+static configRUN_TIME_COUNTER_TYPE prev_total;
+
+static configRUN_TIME_COUNTER_TYPE prev_runtime_of(TaskHandle_t h)
+{
+    for (int i = 0; i < prev_count; i++) {
+        if (prev[i].handle == h) {
+            return prev[i].runtime;
+        }
+    }
+    return 0;   // 新建的任务从 0 开始计
+}
+
+static uint8_t pct(uint64_t part, uint64_t whole)
+{
+    if (whole == 0) {
+        return 0;
+    }
+    uint64_t p = part * 100 / whole;
+    return (uint8_t)(p > 100 ? 100 : p);
+}
+
+static void sample_tasks(mlx_sysmon_record_t *rec)
+{
+    static TaskStatus_t status[MLX_SYSMON_MAX_TASKS + 4];
+    configRUN_TIME_COUNTER_TYPE total;
+
+    UBaseType_t n = uxTaskGetSystemState(status, MLX_SYSMON_MAX_TASKS + 4, &total);
+    configRUN_TIME_COUNTER_TYPE elapsed = total - prev_total;
+
+    for (int core = 0; core < 2; core++) {
+        TaskHandle_t idle = xTaskGetIdleTaskHandleForCore(core);
+        rec->cpu_pct[core] = 100;
+        for (UBaseType_t i = 0; i < n; i++) {
+            if (status[i].xHandle == idle) {
+                uint32_t d = status[i].ulRunTimeCounter - prev_runtime_of(idle);
+                rec->cpu_pct[core] = 100 - pct(d, elapsed);
+            }
+        }
+    }
+
+    rec->ntasks = 0;
+    for (UBaseType_t i = 0; i < n && rec->ntasks < MLX_SYSMON_MAX_TASKS; i++) {
+        const TaskStatus_t *s = &status[i];
+        mlx_sysmon_task_t *t = &rec->tasks[rec->ntasks++];
+        BaseType_t core = xTaskGetCoreID(s->xHandle);
+
+        strncpy(t->name, s->pcTaskName, MLX_SYSMON_NAME_LEN - 1);
+        t->name[MLX_SYSMON_NAME_LEN - 1] = '\0';
+        t->core = (core == tskNO_AFFINITY) ? MLX_SYSMON_NO_CORE : (uint8_t)core;
+        t->cpu_pct = pct(s->ulRunTimeCounter - prev_runtime_of(s->xHandle), elapsed);
+        t->stack_free = (uint16_t)s->usStackHighWaterMark;    // ESP-IDF 中单位为字节
+    }
+
+    prev_count = 0;
+    for (UBaseType_t i = 0; i < n && prev_count < (int)(sizeof(prev) / sizeof(prev[0])); i++) {
+        prev[prev_count].handle = status[i].xHandle;
+        prev[prev_count].runtime = status[i].ulRunTimeCounter;
+        prev_count++;
+    }
+    prev_total = total;
+}
+#endif
+
+/* ================= 采样 ================= */
+void mlx_sysmon_sample(mlx_sysmon_record_t *rec)
+{
+    memset(rec, 0, sizeof(*rec));
+    rec->uptime_ms = (uint32_t)(esp_timer_get_time() / 1000);
+
+    rec->heap_free     = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    rec->heap_min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    rec->heap_largest  = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    rec->psram_free    = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+
+#if SYSMON_RUNTIME
+    sample_tasks(rec);
+#else
+    mlx_sysmon_task_t *t = &rec->tasks[0];
+    strncpy(t->name, pcTaskGetName(NULL), MLX_SYSMON_NAME_LEN - 1);
+    t->core = (uint8_t)xPortGetCoreID();
+    t->stack_free = (uint16_t)uxTaskGetStackHighWaterMark(NULL);
+    rec->ntasks = 1;
+#endif
+}
+
+/* ================= 输出 ================= */
+
+/*
+ * METRICS t=<ms> cpu=<c0>,<c1> heap=<free>/<min>/<largest> psram=<free> <任务>...
+ * 任务项：<名字>:<核 0 / 1，不绑核为 *>:<cpu%>:<最低剩余栈字节>
+ */
+void mlx_sysmon_emit(const mlx_sysmon_record_t *rec)
+{
+    char line[512];
+    int len = snprintf(line, sizeof(line),
+                       "METRICS t=%" PRIu32 " cpu=%u,%u heap=%" PRIu32 "/%" PRIu32 "/%" PRIu32
+                       " psram=%" PRIu32,
+                       rec->uptime_ms, rec->cpu_pct[0], rec->cpu_pct[1],
+                       rec->heap_free, rec->heap_min_free, rec->heap_largest, rec->psram_free);
+
+    for (int i = 0; i < rec->ntasks && len < (int)sizeof(line); i++) {
+        const mlx_sysmon_task_t *t = &rec->tasks[i];
+        char core = (t->core == MLX_SYSMON_NO_CORE) ? '*' : (char)('0' + t->core);
+        len += snprintf(line + len, sizeof(line) - len, " %s:%c:%u:%u",
+                        t->name, core, t->cpu_pct, t->stack_free);
+    }
+
+    ESP_LOGI(TAG, "%s", line);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * 系统资源监控
+ *
+ * 周期采样每个任务的栈最低剩余和 CPU 占用、每个核的利用率、内部 RAM / PSRAM
+ * 的堆余量，汇总成定长的 mlx_sysmon_record_t，用来确定任务栈大小和加重处理前的余量。
+ * mlx_sysmon_emit 在日志（控制台 UART）里打印一行 METRICS；帧走 USB 口时日志不在那里，
+ * 所以 main.c 同时把记录编码成 MLX_PROTO_TYPE_METRICS 包（mlx_proto.h）随帧发送，
+ * 主机端 mlx90640_host.c / mlx_receiver.py 解出来。
+ *
+ * 任务列表和 CPU 占用依赖 CONFIG_FREERTOS_USE_TRACE_FACILITY 和
+ * CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS（见 sdkconfig.defaults）；
+ * 未开启时只报告堆和调用任务自身的栈。
+ */
+
+#define MLX_SYSMON_MAX_TASKS    16
+#define MLX_SYSMON_NAME_LEN     12
+#define MLX_SYSMON_NO_CORE      0xFF
+
+typedef struct {
+    char     name[MLX_SYSMON_NAME_LEN];
+    uint8_t  core;              // 绑定的核，MLX_SYSMON_NO_CORE 表示不绑核
+    uint8_t  cpu_pct;           // 本窗口内占单核时间的百分比
+    uint16_t stack_free;        // 历史最低剩余栈（字节）
+} mlx_sysmon_task_t;
+
+typedef struct {
+    uint32_t uptime_ms;
+    uint8_t  cpu_pct[2];        // 各核利用率（100 - idle）
+    uint8_t  ntasks;
+    uint8_t  reserved;
+    uint32_t heap_free;         // 内部 RAM
+    uint32_t heap_min_free;     // 内部 RAM 历史最低
+    uint32_t heap_largest;      // 内部 RAM 最大连续块
+    uint32_t psram_free;
+    mlx_sysmon_task_t tasks[MLX_SYSMON_MAX_TASKS];
+} mlx_sysmon_record_t;
+
+/* 采样并以上一次采样为窗口起点计算 CPU 占用 */
+void mlx_sysmon_sample(mlx_sysmon_record_t *rec);
+
+/* 打印一行 METRICS 记录 */
+void mlx_sysmon_emit(const mlx_sysmon_record_t *rec);
@@ -0,0 +1,86 @@
+#include "mlx_usbout.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/usb_serial_jtag.h"
+#include "driver/usb_serial_jtag_vfs.h"
+#include "esp_timer.h"
+#include "esp_idf_version.h"
+
+/* 估算排空时间用的保守吞吐（全速 USB 的下限） */
+#define USB_DRAIN_BYTES_PER_S   (256 * 1024)
+
+static TickType_t write_timeout;
+static mlx_usbout_stats_t stats;
+static int64_t last_write_us;
+
+esp_err_t mlx_usbout_init(uint32_t write_timeout_ms)
+{
+    usb_serial_jtag_driver_config_t cfg = {
+        .tx_buffer_size = MLX_USBOUT_TX_RING,
+        .rx_buffer_size = MLX_USBOUT_RX_RING,
+    };
+
+    write_timeout = pdMS_TO_TICKS(write_timeout_ms);
+    esp_err_t err = usb_serial_jtag_driver_install(&cfg);
+#if CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG
+    /* 控制台也在 USB 上时让 stdio 改走同一个驱动，日志与帧按整次写入交错 */
+    if (err == ESP_OK) {
+        usb_serial_jtag_vfs_use_driver();
+    }
+#endif
+    return err;
+}
+
+bool mlx_usbout_write(const void *data, size_t len)
+{
+    int64_t t0 = esp_timer_get_time();
+    int n = usb_serial_jtag_write_bytes(data, len, write_timeout);
+    last_write_us = esp_timer_get_time();
+    uint32_t dt = (uint32_t)(last_write_us - t0);
+
+    /* 统计由 stream_report 在另一个核上读出清零，全部用原子操作 */
+    uint32_t max = __atomic_load_n(&stats.max_write_us, __ATOMIC_RELAXED);
+    while (dt > max &&
+           !__atomic_compare_exchange_n(&stats.max_write_us, &max, dt, false,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    if (n != (int)len) {
+        __atomic_fetch_add(&stats.drops, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    __atomic_fetch_add(&stats.packets, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats.bytes, (uint64_t)len, __ATOMIC_RELAXED);
+    return true;
+}
+
+bool mlx_usbout_wait_tx_done(uint32_t timeout_ms)
+{
+    if (!usb_serial_jtag_is_connected()) {
+        return true;
+    }
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 4, 0)
+    return usb_serial_jtag_wait_tx_done(pdMS_TO_TICKS(timeout_ms)) == ESP_OK;
+#else
+    /* 旧驱动不能查询环形缓冲，按最后一次写入后整个缓冲以全速发完所需的时间估算 */
+    int64_t idle_us = (int64_t)MLX_USBOUT_TX_RING * 1000000 / USB_DRAIN_BYTES_PER_S;
+    int64_t wait_us = last_write_us + idle_us - esp_timer_get_time();
+    if (wait_us <= 0) {
+        return true;
+    }
+    if (wait_us > (int64_t)timeout_ms * 1000) {
+        return false;
+    }
+    vTaskDelay(pdMS_TO_TICKS((wait_us + 999) / 1000) + 1);
+    return true;
+#endif
+}
+
+/* 各字段分别原子清零：窗口边界上的一个包可能分到相邻两个窗口，累计值不丢 */
+void mlx_usbout_get_stats(mlx_usbout_stats_t *out)
+{
+    out->packets = __atomic_exchange_n(&stats.packets, 0, __ATOMIC_RELAXED);
+    out->drops = __atomic_exchange_n(&stats.drops, 0, __ATOMIC_RELAXED);
+    out->bytes = __atomic_exchange_n(&stats.bytes, 0, __ATOMIC_RELAXED);
+    out->max_write_us = __atomic_exchange_n(&stats.max_write_us, 0, __ATOMIC_RELAXED);
+}
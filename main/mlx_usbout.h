@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "esp_err.h"
+
+/*
+ * USB Serial/JTAG 输出后端
+ *
+ * 直接写 S3 内置 USB Serial/JTAG 驱动的 TX 环形缓冲，不经过日志 UART。
+ * 每个包整包写入或整包丢弃（驱动的环形缓冲是全有或全无语义），
+ * 主机断开或读得慢时最多等待 write_timeout，然后丢包计数，采集端不会被卡住。
+ *
+ * 按规格估算（未在硬件上实测）：USB 全速批量端点吞吐在数百 KB/s，
+ * 64Hz 子页率下二进制帧约 100KB/s，16KB 的环形缓冲能吸收主机侧约 150ms 的调度抖动。
+ * 实际数字看 main.c 的 usb 统计行和 mlx_proto.py 的 measure。
+ * 使用时应关闭 USB 上的次级控制台（见 sdkconfig.defaults）。
+ */
+
+#define MLX_USBOUT_TX_RING      16384   // 约 10 个二进制帧
+#define MLX_USBOUT_RX_RING      256
+
+typedef struct {
+    uint32_t packets;
+    uint32_t drops;             // 环形缓冲满（主机跟不上或未连接）
+    uint64_t bytes;
+    uint32_t max_write_us;      // 单次写入（拷贝进环形缓冲）的最长耗时
+} mlx_usbout_stats_t;
+
+esp_err_t mlx_usbout_init(uint32_t write_timeout_ms);
+
+/* 整包写入；成功返回 true，缓冲满时丢弃并返回 false */
+bool mlx_usbout_write(const void *data, size_t len);
+
+/*
+ * 等 TX 环形缓冲和硬件 FIFO 发完（进 light sleep 之前调用）。
+ * 发完或主机未连接（数据反正发不出去）返回 true，超时返回 false
+ */
+bool mlx_usbout_wait_tx_done(uint32_t timeout_ms);
+
+/* 读出并清零统计窗口；可以在写入任务以外的任务（另一个核）上调用 */
+void mlx_usbout_get_stats(mlx_usbout_stats_t *stats);